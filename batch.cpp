@@ -0,0 +1,251 @@
+#include "batch.h"
+#include "chess_engine.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <cctype>
+
+namespace {
+
+struct BatchJob {
+    size_t index;
+    std::string line;
+};
+
+bool is_number(const std::string& s) {
+    return !s.empty() && std::all_of(s.begin(), s.end(), [](unsigned char c) { return std::isdigit(c); });
+}
+
+} // namespace
+
+// Linha EPD ("<4 campos> op1 ...; id \"x\";") ou FEN completa -> FEN + id
+bool parse_epd(const std::string& line, std::string& fen, std::string& id) {
+    std::istringstream ss(line);
+    std::string placement, turn, castling, ep;
+    if (!(ss >> placement >> turn >> castling >> ep)) return false;
+    if (!valid_placement(placement) || (turn != "w" && turn != "b")) return false;
+
+    std::string rest;
+    std::getline(ss, rest);
+    std::istringstream clocks(rest);
+    std::string half, full;
+    if (clocks >> half >> full && is_number(half) && is_number(full)) {
+        fen = placement + " " + turn + " " + castling + " " + ep + " " + half + " " + full;
+        std::getline(clocks, rest);
+    } else {
+        fen = placement + " " + turn + " " + castling + " " + ep + " 0 1";
+    }
+
+    id.clear();
+    size_t pos = rest.find("id \"");
+    if (pos != std::string::npos && (pos == 0 || rest[pos - 1] == ' ' || rest[pos - 1] == ';')) {
+        size_t end = rest.find('"', pos + 4);
+        if (end != std::string::npos) id = rest.substr(pos + 4, end - pos - 4);
+    }
+    return true;
+}
+
+std::string analyse_epd(ChessEngine& engine, size_t index, const std::string& line, const SearchLimits& limits,
+                        uint64_t* nodes) {
+    if (nodes) *nodes = 0;
+    std::ostringstream json;
+    json << "{\"index\":" << index;
+
+    std::string fen, id;
+    ChessBoard board;
+    bool ok = parse_epd(line, fen, id);
+    if (ok) {
+        board.from_fen(fen);
+        ok = valid_position(board);
+    }
+    if (!id.empty()) json << ",\"id\":\"" << json_escape(id) << "\"";
+    if (!ok) {
+        json << ",\"input\":\"" << json_escape(line) << "\",\"error\":\"invalid position\"}";
+        return json.str();
+    }
+
+    // Históricos da posição anterior não servem; a TT fica (zerar a fatia do
+    // worker a cada posição custava mais que a busca em profundidades baixas)
+    engine.clear_history();
+    Move best = engine.get_best_move(board, limits);
+    const SearchStats& stats = engine.get_search_stats();
+    if (nodes) *nodes = stats.nodes;
+
+    json << ",\"fen\":\"" << fen << "\"";
+    if (best.from == NO_SQUARE) {
+        json << ",\"bestmove\":null";
+    } else {
+        json << ",\"bestmove\":\"" << best.to_string() << "\"";
+        if (int mate = ChessEngine::mate_in(stats.score)) json << ",\"score\":{\"mate\":" << mate << "}";
+        else json << ",\"score\":{\"cp\":" << ChessEngine::score_to_cp(stats.score) << "}";
+    }
+    json << ",\"depth\":" << stats.depth << ",\"seldepth\":" << stats.seldepth
+         << ",\"nodes\":" << stats.nodes << ",\"time_ms\":" << stats.time_ms << ",\"pv\":[";
+    for (size_t i = 0; i < stats.pv.size(); i++) json << (i ? "," : "") << "\"" << stats.pv[i].to_string() << "\"";
+    json << "]}";
+    return json.str();
+}
+
+// from_fen não valida a entrada: checa peças e a soma de cada fileira
+bool valid_placement(const std::string& placement) {
+    int rank_count = 1, files = 0;
+    for (char c : placement) {
+        if (c == '/') {
+            if (files != 8) return false;
+            rank_count++; files = 0;
+        } else if (c >= '1' && c <= '8') {
+            files += c - '0';
+        } else if (std::string("pnbrqkPNBRQK").find(c) != std::string::npos) {
+            files++;
+        } else {
+            return false;
+        }
+        if (files > 8) return false;
+    }
+    return rank_count == 8 && files == 8;
+}
+
+// Um rei de cada cor e o lado que não joga fora de xeque
+bool valid_position(const ChessBoard& board) {
+    int kings[2] = { 0, 0 };
+    for (Square sq = 0; sq < 64; sq++) {
+        if (board.get_piece(sq) == KING) kings[board.get_piece_color(sq)]++;
+    }
+    Color them = (board.get_side_to_move() == WHITE) ? BLACK : WHITE;
+    return kings[WHITE] == 1 && kings[BLACK] == 1 && !board.is_check(them);
+}
+
+std::string json_escape(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') { out += '\\'; out += c; }
+        else if ((unsigned char)c < 0x20) out += ' ';
+        else out += c;
+    }
+    return out;
+}
+
+bool parse_batch_options(const std::vector<std::string>& args, BatchOptions& options, std::string& error) {
+    for (size_t i = 0; i < args.size(); i++) {
+        const std::string& arg = args[i];
+        bool has_value = (i + 1 < args.size());
+        if (arg == "--unordered") options.ordered = false;
+        else if (arg.rfind("--", 0) == 0 && !has_value) { error = "missing value for " + arg; return false; }
+        else if (arg == "--threads") options.threads = std::max(1, std::atoi(args[++i].c_str()));
+        else if (arg == "--depth") options.depth = std::max(0, std::atoi(args[++i].c_str()));
+        else if (arg == "--nodes") options.nodes = std::strtoull(args[++i].c_str(), nullptr, 10);
+        else if (arg == "--movetime") options.movetime = std::atoi(args[++i].c_str());
+        else if (arg == "--hash") options.hash_mb = std::max(1, std::atoi(args[++i].c_str()));
+        else if (arg == "--network") options.network = args[++i];
+        else if (arg.rfind("--", 0) == 0) { error = "unknown option " + arg; return false; }
+        else options.input = arg;
+    }
+    return true;
+}
+
+size_t run_batch(const BatchOptions& options, std::istream& in, std::ostream& out) {
+    const int threads = std::max(1, options.threads);
+    // Posições lidas e ainda não escritas (fila + buffer de reordenação)
+    const size_t max_in_flight = (size_t)threads * 4;
+
+    SearchLimits limits;
+    limits.depth = options.depth;
+    limits.nodes = options.nodes;
+    limits.movetime = options.movetime;
+    limits.move_overhead = 0;
+    if (limits.depth == 0 && limits.nodes == 0 && limits.movetime < 0) limits.depth = BATCH_DEFAULT_DEPTH;
+
+    std::mutex mutex;
+    std::condition_variable queue_cv;  // Workers: há trabalho (ou acabou a entrada)
+    std::condition_variable space_cv;  // Leitor: há espaço para mais posições
+    std::deque<BatchJob> queue;
+    std::map<size_t, std::string> pending; // Resultados fora de ordem (modo ordenado)
+    size_t read_count = 0, written_count = 0, next_to_write = 0;
+    bool input_done = false;
+    uint64_t total_nodes = 0;
+
+    // Uma rede para todos os workers (só leitura durante a busca)
+    std::shared_ptr<NNUENetwork> network;
+    if (!options.network.empty()) {
+        network = std::make_shared<NNUENetwork>();
+        if (!network->load(options.network)) {
+            std::cerr << "batch: cannot load network " << options.network << std::endl;
+            return 0;
+        }
+    }
+
+    auto worker = [&]() {
+        ChessEngine engine;
+        engine.set_silent(true);
+        engine.set_network(network);
+        engine.set_hash_size(std::max<size_t>(1, options.hash_mb / threads));
+
+        while (true) {
+            BatchJob job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                queue_cv.wait(lock, [&] { return !queue.empty() || input_done; });
+                if (queue.empty()) return;
+                job = std::move(queue.front());
+                queue.pop_front();
+            }
+
+            uint64_t nodes = 0;
+            std::string result = analyse_epd(engine, job.index, job.line, limits, &nodes);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            total_nodes += nodes;
+            if (!options.ordered) {
+                out << result << '\n';
+                written_count++;
+            } else {
+                pending.emplace(job.index, std::move(result));
+                for (auto it = pending.find(next_to_write); it != pending.end(); it = pending.find(next_to_write)) {
+                    out << it->second << '\n';
+                    pending.erase(it);
+                    next_to_write++;
+                    written_count++;
+                }
+            }
+            out.flush();
+            space_cv.notify_one();
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; t++) pool.emplace_back(worker);
+
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.find_first_not_of(" \t") == std::string::npos || line[0] == '#') continue;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        space_cv.wait(lock, [&] { return read_count - written_count < max_in_flight; });
+        queue.push_back({ read_count++, line });
+        queue_cv.notify_one();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        input_done = true;
+    }
+    queue_cv.notify_all();
+    for (auto& th : pool) th.join();
+
+    int64_t time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << "Positions       : " << read_count << "\n"
+              << "Threads         : " << threads << "\n"
+              << "Total time (ms) : " << time_ms << "\n"
+              << "Nodes searched  : " << total_nodes << "\n"
+              << "Nodes/second    : " << total_nodes * 1000 / std::max<int64_t>(1, time_ms) << std::endl;
+    return read_count;
+}
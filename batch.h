@@ -0,0 +1,49 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+class ChessBoard;
+class ChessEngine;
+struct SearchLimits;
+
+// Análise em lote: lê EPD/FEN (uma posição por linha), distribui entre um
+// pool de workers (cada um com sua ChessEngine) e escreve uma linha JSON
+// por posição (NDJSON). O número de posições em andamento é limitado, então
+// a memória não cresce com o tamanho da entrada.
+const int BATCH_DEFAULT_DEPTH = 8;
+
+struct BatchOptions {
+    int threads = 1;
+    int depth = 0;         // Limites por posição (nenhum informado -> BATCH_DEFAULT_DEPTH)
+    uint64_t nodes = 0;
+    int movetime = -1;
+    size_t hash_mb = 64;   // TT total, dividida entre os workers
+    bool ordered = true;   // Saída na ordem da entrada (false = ordem de conclusão)
+    std::string network;   // Rede NNUE; vazio = avaliação manual
+    std::string input;     // Arquivo EPD; vazio ou "-" = stdin
+};
+
+// batch [--threads N] [--depth D] [--nodes N] [--movetime MS] [--hash MB] [--network ARQ] [--unordered] [arquivo]
+bool parse_batch_options(const std::vector<std::string>& args, BatchOptions& options, std::string& error);
+
+// Devolve o número de posições processadas (resumo em stderr)
+size_t run_batch(const BatchOptions& options, std::istream& in, std::ostream& out);
+
+// Linha EPD ("<4 campos> op1 ...; id \"x\";") ou FEN completa -> FEN + id
+bool parse_epd(const std::string& line, std::string& fen, std::string& id);
+
+// Analisa uma linha de entrada e devolve a linha JSON de saída (também usada
+// pelos workers distribuídos). Em nodes, os nós buscados (0 se não houve busca)
+std::string analyse_epd(ChessEngine& engine, size_t index, const std::string& line, const SearchLimits& limits,
+                        uint64_t* nodes = nullptr);
+
+// Validação da entrada e saída JSON (também usadas pelo servidor de análise)
+bool valid_placement(const std::string& placement); // Primeiro campo da FEN
+bool valid_position(const ChessBoard& board);       // Um rei de cada cor, lado que não joga fora de xeque
+std::string json_escape(const std::string& s);
+
+#endif // BATCH_H
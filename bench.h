@@ -0,0 +1,26 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Benchmark de busca: posições fixas, profundidade fixa, engine nova por
+// posição. O total de nós é a "assinatura" funcional da versão: qualquer
+// mudança no resultado da busca altera o número.
+const int BENCH_DEFAULT_DEPTH = 6;
+const size_t BENCH_HASH_MB = 64; // TT de cada engine do bench (o total de nós depende do tamanho)
+
+struct BenchResult {
+    uint64_t nodes = 0;
+    int64_t time_ms = 0;
+    uint64_t nps = 0;
+};
+
+const std::vector<std::string>& bench_positions();
+
+// Cada thread busca posições diferentes com sua própria engine, então o
+// total de nós não depende do número de threads.
+BenchResult run_bench(int depth = BENCH_DEFAULT_DEPTH, int threads = 1);
+
+#endif // BENCH_H
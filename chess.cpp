@@ -1,4 +1,6 @@
 #include "chess.h"
+#include "pesto.h"
+#include "polyglot_random.h"
 #include <iostream>
 #include <sstream>
 #include <algorithm>
@@ -23,6 +25,9 @@ uint64_t ChessBoard::zobrist_side;
 uint64_t ChessBoard::zobrist_castling[4];
 uint64_t ChessBoard::zobrist_enpassant[8];
 
+int ChessBoard::psq_mg[2][6][64];
+int ChessBoard::psq_eg[2][6][64];
+
 // Bit helpers
 inline Bitboard set_bit(Square sq) { return 1ULL << sq; }
 inline bool get_bit(Bitboard bb, Square sq) { return (bb >> sq) & 1; }
@@ -79,6 +84,97 @@ uint64_t ChessBoard::compute_hash() const {
     return hash;
 }
 
+// Chave no formato Polyglot (livros de abertura .bin)
+uint64_t ChessBoard::polyglot_key() const {
+    uint64_t key = 0;
+
+    for (int sq = 0; sq < 64; sq++) {
+        PieceType pt = get_piece(sq);
+        if (pt != NONE) {
+            int kind = 2 * pt + (get_piece_color(sq) == WHITE ? 1 : 0);
+            key ^= POLYGLOT_RANDOM[64 * kind + sq];
+        }
+    }
+
+    if (castling_rights[WHITE][0]) key ^= POLYGLOT_RANDOM[POLYGLOT_CASTLE_OFFSET + 0];
+    if (castling_rights[WHITE][1]) key ^= POLYGLOT_RANDOM[POLYGLOT_CASTLE_OFFSET + 1];
+    if (castling_rights[BLACK][0]) key ^= POLYGLOT_RANDOM[POLYGLOT_CASTLE_OFFSET + 2];
+    if (castling_rights[BLACK][1]) key ^= POLYGLOT_RANDOM[POLYGLOT_CASTLE_OFFSET + 3];
+
+    // O en passant só entra se algum peão do lado a jogar puder capturar
+    if (en_passant_square != NO_SQUARE) {
+        const auto& pawns = (side_to_move == WHITE) ? pieces_white[PAWN] : pieces_black[PAWN];
+        Color them = (side_to_move == WHITE) ? BLACK : WHITE;
+        if (get_pawn_attacks(en_passant_square, them) & pawns) {
+            key ^= POLYGLOT_RANDOM[POLYGLOT_EP_OFFSET + get_file(en_passant_square)];
+        }
+    }
+
+    if (side_to_move == WHITE) key ^= POLYGLOT_RANDOM[POLYGLOT_TURN_OFFSET];
+
+    return key;
+}
+
+// --- AVALIAÇÃO INCREMENTAL ---
+
+void ChessBoard::init_psq() {
+    for (int pt = 0; pt < 6; pt++) {
+        for (int sq = 0; sq < 64; sq++) {
+            // Tabelas PeSTO começam em a8: brancas espelham, pretas não
+            psq_mg[WHITE][pt][sq] = PIECE_VALUE_MG[pt] + PST_MG_TABLES[pt][sq ^ 56];
+            psq_eg[WHITE][pt][sq] = PIECE_VALUE_EG[pt] + PST_EG_TABLES[pt][sq ^ 56];
+            psq_mg[BLACK][pt][sq] = -(PIECE_VALUE_MG[pt] + PST_MG_TABLES[pt][sq]);
+            psq_eg[BLACK][pt][sq] = -(PIECE_VALUE_EG[pt] + PST_EG_TABLES[pt][sq]);
+        }
+    }
+}
+
+inline void ChessBoard::psq_add(Color c, PieceType pt, Square sq) {
+    mg_score += psq_mg[c][pt][sq];
+    eg_score += psq_eg[c][pt][sq];
+    game_phase += PHASE_INC[pt];
+}
+
+inline void ChessBoard::psq_remove(Color c, PieceType pt, Square sq) {
+    mg_score -= psq_mg[c][pt][sq];
+    eg_score -= psq_eg[c][pt][sq];
+    game_phase -= PHASE_INC[pt];
+}
+
+// Toda alteração de peça em make_move_internal passa por aqui: atualiza as
+// somas da avaliação e registra o delta para consumidores incrementais
+inline void ChessBoard::piece_added(Color c, PieceType pt, Square sq) {
+    psq_add(c, pt, sq);
+    dirty.added[dirty.added_count++] = {c, pt, sq};
+}
+
+inline void ChessBoard::piece_removed(Color c, PieceType pt, Square sq) {
+    psq_remove(c, pt, sq);
+    dirty.removed[dirty.removed_count++] = {c, pt, sq};
+}
+
+// Recalcula as somas do zero (usado no setup via FEN)
+void ChessBoard::compute_psq() {
+    mg_score = eg_score = game_phase = 0;
+    for (int c = 0; c < 2; c++) {
+        const auto& pieces = (c == WHITE) ? pieces_white : pieces_black;
+        for (int pt = 0; pt < 6; pt++) {
+            Bitboard bb = pieces[pt];
+            while (bb) { psq_add((Color)c, (PieceType)pt, lsb(bb)); bb &= bb - 1; }
+        }
+    }
+}
+
+// Hash apenas dos peões (reusa as chaves Zobrist das peças)
+uint64_t ChessBoard::compute_pawn_hash() const {
+    uint64_t hash = 0;
+    for (int c = 0; c < 2; c++) {
+        Bitboard pawns = (c == WHITE) ? pieces_white[PAWN] : pieces_black[PAWN];
+        while (pawns) { hash ^= zobrist_pieces[c][PAWN][lsb(pawns)]; pawns &= pawns - 1; }
+    }
+    return hash;
+}
+
 // --- IMPLEMENTAÇÃO DA EXECUÇÃO DE MOVIMENTOS ---
 
 void ChessBoard::make_move_internal(const Move& move) {
@@ -91,6 +187,11 @@ void ChessBoard::make_move_internal(const Move& move) {
     state.halfmove_clock = halfmove_clock;
     state.captured_piece = NONE;
     state.captured_square = NO_SQUARE;
+    state.mg_score = mg_score;
+    state.eg_score = eg_score;
+    state.game_phase = game_phase;
+    state.pawn_hash = pawn_hash;
+    dirty.removed_count = dirty.added_count = 0;
     
     Color us = side_to_move;
     Color them = (us == WHITE) ? BLACK : WHITE;
@@ -108,6 +209,8 @@ void ChessBoard::make_move_internal(const Move& move) {
 
     // [HASH] Remove a peça da origem do hash
     current_hash ^= zobrist_pieces[us][pt][move.from];
+    piece_removed(us, pt, move.from);
+    if (pt == PAWN) pawn_hash ^= zobrist_pieces[us][PAWN][move.from];
 
     // Captura Normal
     if (get_bit(enemy_pieces[PAWN] | enemy_pieces[KNIGHT] | enemy_pieces[BISHOP] | 
@@ -119,6 +222,8 @@ void ChessBoard::make_move_internal(const Move& move) {
             enemy_pieces[cap] &= ~set_bit(move.to);
             // [HASH] Remove a peça capturada do hash
             current_hash ^= zobrist_pieces[them][cap][move.to];
+            piece_removed(them, cap, move.to);
+            if (cap == PAWN) pawn_hash ^= zobrist_pieces[them][PAWN][move.to];
         }
     }
     
@@ -130,6 +235,8 @@ void ChessBoard::make_move_internal(const Move& move) {
         enemy_pieces[PAWN] &= ~set_bit(cap_sq);
         // [HASH] Remove o peão capturado por en-passant
         current_hash ^= zobrist_pieces[them][PAWN][cap_sq];
+        piece_removed(them, PAWN, cap_sq);
+        pawn_hash ^= zobrist_pieces[them][PAWN][cap_sq];
     }
     
     // Mover a peça
@@ -139,6 +246,8 @@ void ChessBoard::make_move_internal(const Move& move) {
     
     // [HASH] Adiciona a peça no destino
     current_hash ^= zobrist_pieces[us][dest_pt][move.to];
+    piece_added(us, dest_pt, move.to);
+    if (dest_pt == PAWN) pawn_hash ^= zobrist_pieces[us][PAWN][move.to];
     
     // Roque (mover torre)
     if (move.is_castle) {
@@ -151,6 +260,8 @@ void ChessBoard::make_move_internal(const Move& move) {
         // [HASH] Atualiza a torre do roque
         current_hash ^= zobrist_pieces[us][ROOK][r_from];
         current_hash ^= zobrist_pieces[us][ROOK][r_to];
+        piece_removed(us, ROOK, r_from);
+        piece_added(us, ROOK, r_to);
     }
     
     // [HASH] Remove direitos de roque antigos do hash
@@ -289,6 +400,12 @@ void ChessBoard::unmake_move() {
     
     halfmove_clock = state.halfmove_clock;
     if (side_to_move == BLACK) fullmove_number--;
+
+    // Somas da avaliação salvas no histórico
+    mg_score = state.mg_score;
+    eg_score = state.eg_score;
+    game_phase = state.game_phase;
+    pawn_hash = state.pawn_hash;
     
     update_bitboards();
 }
@@ -399,6 +516,69 @@ void ChessBoard::generate_castling_moves(std::vector<Move>& moves, Color c) cons
     if (castling_rights[c][1]) if (!get_bit(all_pieces, make_square(1, rank)) && !get_bit(all_pieces, make_square(2, rank)) && !get_bit(all_pieces, make_square(3, rank))) if (!is_square_attacked(make_square(2, rank), c == WHITE ? BLACK : WHITE) && !is_square_attacked(make_square(3, rank), c == WHITE ? BLACK : WHITE)) { Move m(king_sq, make_square(2, rank)); m.is_castle = true; moves.push_back(m); } }
 std::vector<Move> ChessBoard::generate_legal_moves() const { std::vector<Move> moves; moves.reserve(64); generate_pawn_moves(moves, side_to_move); generate_knight_moves(moves, side_to_move); generate_bishop_moves(moves, side_to_move); generate_rook_moves(moves, side_to_move); generate_queen_moves(moves, side_to_move); generate_king_moves(moves, side_to_move); generate_castling_moves(moves, side_to_move);
     std::vector<Move> legal_moves; legal_moves.reserve(moves.size()); for (const auto& move : moves) if (is_legal_move(move)) legal_moves.push_back(move); return legal_moves; }
+
+void ChessBoard::generate_captures(std::vector<Move>& moves, Color c) const {
+    const auto& pieces = (c == WHITE) ? pieces_white : pieces_black;
+    Bitboard enemies = (c == WHITE) ? all_black : all_white;
+    int promo_rank = (c == WHITE) ? 7 : 0;
+    int forward = (c == WHITE) ? 8 : -8;
+
+    // Peões: capturas, en passant e promoções (apenas dama)
+    Bitboard pawns = pieces[PAWN];
+    while (pawns) {
+        Square from = lsb(pawns); pawns &= pawns - 1;
+        Square to = from + forward;
+        if (get_rank(to) == promo_rank && !get_bit(all_pieces, to)) moves.push_back(Move(from, to, QUEEN));
+        Bitboard att = get_pawn_attacks(from, c) & enemies;
+        while (att) {
+            Square to_cap = lsb(att); att &= att - 1;
+            moves.push_back(get_rank(to_cap) == promo_rank ? Move(from, to_cap, QUEEN) : Move(from, to_cap));
+        }
+        if (en_passant_square != NO_SQUARE && (get_pawn_attacks(from, c) & set_bit(en_passant_square))) {
+            Move m(from, en_passant_square); m.is_en_passant = true; moves.push_back(m);
+        }
+    }
+
+    // Demais peças: apenas destinos ocupados pelo adversário
+    for (Bitboard bb = pieces[KNIGHT]; bb; bb &= bb - 1) {
+        Square from = lsb(bb);
+        for (Bitboard att = get_knight_attacks(from) & enemies; att; att &= att - 1) moves.push_back(Move(from, lsb(att)));
+    }
+    for (Bitboard bb = pieces[BISHOP]; bb; bb &= bb - 1) {
+        Square from = lsb(bb);
+        for (Bitboard att = get_bishop_attacks(from, all_pieces) & enemies; att; att &= att - 1) moves.push_back(Move(from, lsb(att)));
+    }
+    for (Bitboard bb = pieces[ROOK]; bb; bb &= bb - 1) {
+        Square from = lsb(bb);
+        for (Bitboard att = get_rook_attacks(from, all_pieces) & enemies; att; att &= att - 1) moves.push_back(Move(from, lsb(att)));
+    }
+    for (Bitboard bb = pieces[QUEEN]; bb; bb &= bb - 1) {
+        Square from = lsb(bb);
+        for (Bitboard att = get_queen_attacks(from, all_pieces) & enemies; att; att &= att - 1) moves.push_back(Move(from, lsb(att)));
+    }
+    if (pieces[KING]) {
+        Square from = lsb(pieces[KING]);
+        for (Bitboard att = get_king_attacks(from) & enemies; att; att &= att - 1) moves.push_back(Move(from, lsb(att)));
+    }
+}
+
+std::vector<Move> ChessBoard::generate_legal_captures() const {
+    std::vector<Move> moves; moves.reserve(32);
+    generate_captures(moves, side_to_move);
+    std::vector<Move> legal_moves; legal_moves.reserve(moves.size());
+    for (const auto& move : moves) if (is_legal_move(move)) legal_moves.push_back(move);
+    return legal_moves;
+}
+
+Bitboard ChessBoard::attackers_to(Square sq, Bitboard occupied) const {
+    return (get_pawn_attacks(sq, BLACK) & pieces_white[PAWN])
+         | (get_pawn_attacks(sq, WHITE) & pieces_black[PAWN])
+         | (get_knight_attacks(sq) & (pieces_white[KNIGHT] | pieces_black[KNIGHT]))
+         | (get_king_attacks(sq) & (pieces_white[KING] | pieces_black[KING]))
+         | (get_bishop_attacks(sq, occupied) & (pieces_white[BISHOP] | pieces_black[BISHOP] | pieces_white[QUEEN] | pieces_black[QUEEN]))
+         | (get_rook_attacks(sq, occupied) & (pieces_white[ROOK] | pieces_black[ROOK] | pieces_white[QUEEN] | pieces_black[QUEEN]));
+}
+
 bool ChessBoard::make_move(const Move& move) { if (is_legal_move(move)) { make_move_internal(move); return true; } return false; }
 bool ChessBoard::is_checkmate(Color c) const { if (!is_check(c)) return false; return generate_legal_moves().empty(); }
 bool ChessBoard::is_stalemate(Color c) const { if (is_check(c)) return false; return generate_legal_moves().empty(); }
@@ -422,11 +602,18 @@ Move Move::from_string(const std::string& s) {
 void ChessBoard::print_board() const { std::cout << "\n  a b c d e f g h\n"; for (int r=7; r>=0; r--) { std::cout << r+1 << " "; for (int f=0; f<8; f++) { PieceType pt = get_piece(make_square(f, r)); char c = '.'; if (pt != NONE) { c = "pnbrqk"[pt]; if (get_piece_color(make_square(f, r)) == WHITE) c = toupper(c); } std::cout << c << " "; } std::cout << r+1 << "\n"; } std::cout << "  a b c d e f g h\n"; }
 
 void ChessBoard::initialize_lookup_tables() {
-    // Inicialização segura com Zobrist
-    init_zobrist();
-    for (Square sq = 0; sq < 64; sq++) { Bitboard moves = 0; int r = get_rank(sq), f = get_file(sq); int offsets[8][2] = {{-2, -1}, {-2, 1}, {-1, -2}, {-1, 2}, {1, -2}, {1, 2}, {2, -1}, {2, 1}}; for (auto& off : offsets) { int nr = r + off[0], nf = f + off[1]; if (nr >= 0 && nr < 8 && nf >= 0 && nf < 8) moves |= set_bit(make_square(nf, nr)); } knight_moves[sq] = moves; }
-    for (Square sq = 0; sq < 64; sq++) { Bitboard moves = 0; int r = get_rank(sq), f = get_file(sq); for (int dr = -1; dr <= 1; dr++) { for (int df = -1; df <= 1; df++) { if (dr == 0 && df == 0) continue; int nr = r + dr, nf = f + df; if (nr >= 0 && nr < 8 && nf >= 0 && nf < 8) moves |= set_bit(make_square(nf, nr)); } } king_moves[sq] = moves; }
-    for (Square sq = 0; sq < 64; sq++) { int r = get_rank(sq), f = get_file(sq); if (r < 7) { if (f > 0) pawn_attacks[WHITE][sq] |= set_bit(make_square(f - 1, r + 1)); if (f < 7) pawn_attacks[WHITE][sq] |= set_bit(make_square(f + 1, r + 1)); } if (r > 0) { if (f > 0) pawn_attacks[BLACK][sq] |= set_bit(make_square(f - 1, r - 1)); if (f < 7) pawn_attacks[BLACK][sq] |= set_bit(make_square(f + 1, r - 1)); } }
+    // Tabelas estáticas montadas uma única vez (inicialização de static local é
+    // thread-safe), para que construir tabuleiros em paralelo não as reescreva
+    static const bool initialized = [] {
+        // Inicialização segura com Zobrist
+        init_zobrist();
+        init_psq();
+        for (Square sq = 0; sq < 64; sq++) { Bitboard moves = 0; int r = get_rank(sq), f = get_file(sq); int offsets[8][2] = {{-2, -1}, {-2, 1}, {-1, -2}, {-1, 2}, {1, -2}, {1, 2}, {2, -1}, {2, 1}}; for (auto& off : offsets) { int nr = r + off[0], nf = f + off[1]; if (nr >= 0 && nr < 8 && nf >= 0 && nf < 8) moves |= set_bit(make_square(nf, nr)); } knight_moves[sq] = moves; }
+        for (Square sq = 0; sq < 64; sq++) { Bitboard moves = 0; int r = get_rank(sq), f = get_file(sq); for (int dr = -1; dr <= 1; dr++) { for (int df = -1; df <= 1; df++) { if (dr == 0 && df == 0) continue; int nr = r + dr, nf = f + df; if (nr >= 0 && nr < 8 && nf >= 0 && nf < 8) moves |= set_bit(make_square(nf, nr)); } } king_moves[sq] = moves; }
+        for (Square sq = 0; sq < 64; sq++) { int r = get_rank(sq), f = get_file(sq); if (r < 7) { if (f > 0) pawn_attacks[WHITE][sq] |= set_bit(make_square(f - 1, r + 1)); if (f < 7) pawn_attacks[WHITE][sq] |= set_bit(make_square(f + 1, r + 1)); } if (r > 0) { if (f > 0) pawn_attacks[BLACK][sq] |= set_bit(make_square(f - 1, r - 1)); if (f < 7) pawn_attacks[BLACK][sq] |= set_bit(make_square(f + 1, r - 1)); } }
+        return true;
+    }();
+    (void)initialized;
 }
 ChessBoard::ChessBoard() { initialize_lookup_tables(); from_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"); }
 ChessBoard::ChessBoard(const std::string& fen) { initialize_lookup_tables(); from_fen(fen); }
@@ -438,5 +625,25 @@ void ChessBoard::from_fen(const std::string& fen) {
     update_bitboards(); side_to_move = (turn == "w") ? WHITE : BLACK; std::memset(castling_rights, 0, sizeof(castling_rights)); if (castling.find('K') != std::string::npos) castling_rights[WHITE][0] = true; if (castling.find('Q') != std::string::npos) castling_rights[WHITE][1] = true; if (castling.find('k') != std::string::npos) castling_rights[BLACK][0] = true; if (castling.find('q') != std::string::npos) castling_rights[BLACK][1] = true; en_passant_square = (ep == "-") ? NO_SQUARE : square_from_string(ep); 
     // [IMPORTANTE] Calcular hash inicial após o setup completo
     current_hash = compute_hash();
+    pawn_hash = compute_pawn_hash();
+    compute_psq();
+    dirty.removed_count = dirty.added_count = 0;
+}
+void ChessBoard::set_position(const std::array<Bitboard, 6>& white, const std::array<Bitboard, 6>& black, Color side, int castling, Square ep_square) {
+    pieces_white = white;
+    pieces_black = black;
+    update_bitboards();
+    side_to_move = side;
+    castling_rights[WHITE][0] = castling & 1;
+    castling_rights[WHITE][1] = castling & 2;
+    castling_rights[BLACK][0] = castling & 4;
+    castling_rights[BLACK][1] = castling & 8;
+    en_passant_square = ep_square;
+    halfmove_clock = 0;
+    fullmove_number = 1;
+    current_hash = compute_hash();
+    pawn_hash = compute_pawn_hash();
+    compute_psq();
+    dirty.removed_count = dirty.added_count = 0;
 }
 std::string ChessBoard::to_fen() const { std::ostringstream fen; for (int r = 7; r >= 0; r--) { int e = 0; for (int f = 0; f < 8; f++) { PieceType pt = get_piece(make_square(f, r)); if (pt == NONE) e++; else { if (e) { fen << e; e = 0; } char p = "pnbrqk"[pt]; if (get_piece_color(make_square(f, r)) == WHITE) p = toupper(p); fen << p; } } if (e) fen << e; if (r > 0) fen << "/"; } fen << " " << (side_to_move == WHITE ? "w" : "b") << " "; bool any = false; if (castling_rights[WHITE][0]) { fen << "K"; any = true; } if (castling_rights[WHITE][1]) { fen << "Q"; any = true; } if (castling_rights[BLACK][0]) { fen << "k"; any = true; } if (castling_rights[BLACK][1]) { fen << "q"; any = true; } if (!any) fen << "-"; fen << " " << (en_passant_square == NO_SQUARE ? "-" : square_to_string(en_passant_square)); fen << " " << halfmove_clock << " " << fullmove_number; return fen.str(); }
\ No newline at end of file
@@ -63,9 +63,24 @@ struct Move {
     static Move from_string(const std::string& move_str);
 };
 
+// Peças alteradas pelo último lance (usado em atualizações incrementais, ex: NNUE)
+struct DirtyPiece {
+    Color color;
+    PieceType piece;
+    Square square;
+};
+
+struct DirtyPieces {
+    int removed_count;
+    int added_count;
+    DirtyPiece removed[2]; // Peça movida (origem) + capturada, ou rei + torre no roque
+    DirtyPiece added[2];   // Peça no destino (+ torre no roque)
+};
+
 // Classe principal do tabuleiro
 class ChessBoard {
     friend class ChessEngine; // Permite acesso rápido para a engine
+    friend class SyzygyTablebases;
 
 private:
     std::array<Bitboard, 6> pieces_white;
@@ -82,6 +97,7 @@ private:
     
     //Zobrist Hash
     uint64_t current_hash;
+    uint64_t pawn_hash; // Apenas peões (chave da pawn hash table)
 
     // Tabelas de números aleatórios para o Hash
     static uint64_t zobrist_pieces[2][6][64]; // [Color][Piece][Square]
@@ -92,6 +108,25 @@ private:
     // Função para inicializar os números aleatórios
     static void init_zobrist();
 
+    // Avaliação incremental (material + PST PeSTO, brancas - pretas)
+    int mg_score;
+    int eg_score;
+    int game_phase;
+
+    // Tabelas combinadas material + PST, já com o sinal da cor
+    static int psq_mg[2][6][64];
+    static int psq_eg[2][6][64];
+    static void init_psq();
+
+    void psq_add(Color c, PieceType pt, Square sq);
+    void psq_remove(Color c, PieceType pt, Square sq);
+    void compute_psq();
+
+    // Deltas do último make_move_internal
+    DirtyPieces dirty;
+    void piece_added(Color c, PieceType pt, Square sq);
+    void piece_removed(Color c, PieceType pt, Square sq);
+
 
     // [CRÍTICO] Estrutura robusta para o histórico
     struct GameState {
@@ -102,6 +137,10 @@ private:
         PieceType captured_piece;
         Square captured_square;
         PieceType moved_piece; 
+        int mg_score;
+        int eg_score;
+        int game_phase;
+        uint64_t pawn_hash;
     };
     std::vector<GameState> history;
     
@@ -135,6 +174,7 @@ private:
     void generate_queen_moves(std::vector<Move>& moves, Color c) const;
     void generate_king_moves(std::vector<Move>& moves, Color c) const;
     void generate_castling_moves(std::vector<Move>& moves, Color c) const;
+    void generate_captures(std::vector<Move>& moves, Color c) const;
     
     bool is_legal_move(const Move& move) const;
     void make_move_internal(const Move& move);
@@ -144,10 +184,14 @@ public:
     ChessBoard(const std::string& fen);
     
     std::vector<Move> generate_legal_moves() const;
+    // Apenas capturas (incl. en passant) e promoções a dama, para a quiescência
+    std::vector<Move> generate_legal_captures() const;
     bool make_move(const Move& move);
     void unmake_move();
     
     bool is_check(Color c) const;
+    // Atacantes (das duas cores) de uma casa com ocupação arbitrária (usado pelo SEE)
+    Bitboard attackers_to(Square sq, Bitboard occupied) const;
     bool is_checkmate(Color c) const;
     bool is_stalemate(Color c) const;
     bool is_game_over() const;
@@ -164,6 +208,10 @@ public:
     void print_board() const;
     std::string to_fen() const;
     void from_fen(const std::string& fen);
+    // Posição a partir dos bitboards, sem passar por texto (posições compactadas).
+    // castling: bits 1 = K, 2 = Q, 4 = k, 8 = q
+    void set_position(const std::array<Bitboard, 6>& white, const std::array<Bitboard, 6>& black,
+                      Color side, int castling, Square ep_square);
     
     static Square square_from_string(const std::string& str);
     static std::string square_to_string(Square sq);
@@ -172,9 +220,21 @@ public:
     static Square make_square(int file, int rank) { return rank * 8 + file; }
 
     uint64_t get_hash() const { return current_hash; }
+
+    // Somas incrementais da avaliação (perspectiva das brancas)
+    int get_mg_score() const { return mg_score; }
+    int get_eg_score() const { return eg_score; }
+    int get_game_phase() const { return game_phase; }
+
+    // Peças adicionadas/removidas pelo último lance executado
+    const DirtyPieces& get_dirty_pieces() const { return dirty; }
     
     // [NOVO] Recalcula o hash do zero (para validação ou init)
     uint64_t compute_hash() const;
+    uint64_t get_pawn_hash() const { return pawn_hash; }
+    uint64_t compute_pawn_hash() const;
+    // Chave compatível com livros Polyglot (independente de get_hash)
+    uint64_t polyglot_key() const;
     
 };
 
@@ -1,196 +1,676 @@
 #include "chess_engine.h"
+#include "pesto.h"
+#include "eval_params.h"
 #include <chrono>
 #include <algorithm>
 #include <climits>
 #include <cstring>
 #include <iostream>
+#include <sstream>
+#include <thread>
 
 const int INFINITY_SCORE = 1000000000;
 const int MATE_SCORE = 900000000;
-const int TIME_LIMIT_MS = 1500; 
+const int NO_EVAL = -INFINITY_SCORE;
+const int TB_WIN_SCORE = MATE_SCORE - MAX_PLY - 1; // Vitória de tablebase (- ply): logo abaixo da faixa de mate
+const int TB_WIN_CP = 20000; // Vitória de tablebase como "score cp"
+const int TIME_LIMIT_MS = 1500; // Orçamento padrão quando não há relógio
+const uint64_t TIME_CHECK_NODES = 2048;
+const int QS_DELTA_MARGIN = 200; // Folga do delta pruning na quiescência
 
 const int ChessEngine::PIECE_VALUES[7] = { 82, 337, 365, 477, 1025, 20000, 0 };
 
-const int MOBILITY_BONUS[] = {
-    0, // Peão
-    4, // Cavalo
-    3, // Bispo
-    2, // Torre
-    1, // Dama
-    0, // Rei
-    0
-};
+// Casas que contam para a mobilidade de cada cor. Hoje todas as casas
+// atacadas contam (inclusive as ocupadas por peças próprias).
+const Bitboard MOBILITY_AREA[2] = { ~0ULL, ~0ULL };
 
-// --- TABELAS PESTO ---
-const int PST_PAWN[64] = {
-      0,   0,   0,   0,   0,   0,   0,   0, // Rank 8
-     98, 134,  61,  95,  68, 126,  34, -11, // Rank 7
-     -6,   7,  26,  31,  65,  56,  25, -20, // Rank 6
-    -14,  13,   6,  21,  23,  12,  17, -23, // Rank 5
-    -27,  -2,  -5,  12,  17,   6,  10, -25, // Rank 4
-    -26,  -4,  -4, -10,   3,   3,  33, -12, // Rank 3
-    -35,  -1, -20, -23, -15,  24,  38, -22, // Rank 2
-      0,   0,   0,   0,   0,   0,   0,   0  // Rank 1
-};
+// --- GERENCIAMENTO DE TEMPO ---
+void TimeManager::init(const SearchLimits& limits, Color side) {
+    start = std::chrono::steady_clock::now();
+    last_best = Move();
+    stability = 0;
+    limited = false;
+    fixed_time = false;
+    soft_ms = hard_ms = 0;
 
-const int PST_KNIGHT[64] = {
-   -167, -89, -34, -49,  61, -97, -15,-107, // Rank 8
-    -73, -41,  72,  36,  23,  62,   7, -17, // Rank 7
-    -47,  60,  37,  65,  84, 129,  73,  44, // Rank 6
-     -9,  17,  19,  53,  37,  69,  18,  22, // Rank 5
-    -13,   4,  16,  13,  28,  19,  21,  -8, // Rank 4
-    -23,  -9,  12,  10,  19,  17,  25, -16, // Rank 3
-    -29, -53, -12,  -3,  -1,  18, -14, -19, // Rank 2
-   -105, -21, -58, -33, -17, -28, -19, -23  // Rank 1
-};
+    if (limits.infinite) return;
 
-const int PST_BISHOP[64] = {
-    -29,   4, -82, -37, -25, -42,   7,  -8, // Rank 8
-    -26,  16, -18, -13,  30,  59,  18, -47, // Rank 7
-    -16,  37,  43,  40,  35,  50,  37,  -2, // Rank 6
-     -4,   5,  19,  50,  37,  37,   7,  -2, // Rank 5
-     -6,  13,  13,  26,  34,  12,  10,   4, // Rank 4
-      0,  15,  15,  15,  14,  27,  18,  10, // Rank 3
-      4,  15,  16,   0,   7,  21,  33,   1, // Rank 2
-    -33,  -3, -14, -21, -13, -12, -39, -21  // Rank 1
-};
+    // Tempo fixo por lance: usa tudo, sem parada antecipada
+    if (limits.movetime >= 0) {
+        limited = true;
+        fixed_time = true;
+        soft_ms = hard_ms = std::max<int64_t>(1, limits.movetime - limits.move_overhead);
+        return;
+    }
 
-const int PST_ROOK[64] = {
-     32,  42,  32,  51,  63,   9,  31,  43, // Rank 8
-     27,  32,  58,  62,  80,  67,  26,  44, // Rank 7
-     -5,  19,  26,  36,  17,  45,  61,  16, // Rank 6
-    -24, -11,   7,  26,  24,  35,  -8, -20, // Rank 5
-    -36, -26, -12,  -1,   9,  -7,   6, -23, // Rank 4
-    -45, -25, -16, -17,   3,   0,  -5, -33, // Rank 3
-    -44, -16, -20,  -9,  -1,  11,  -6, -71, // Rank 2
-    -19, -13,   1,  17,  16,   7, -37, -26  // Rank 1
-};
+    int time_left = (side == WHITE) ? limits.wtime : limits.btime;
+    int inc = (side == WHITE) ? limits.winc : limits.binc;
+    if (time_left < 0) return; // Sem relógio (ex: apenas "go depth")
 
-const int PST_QUEEN[64] = {
-    -28,   0,  29,  12,  59,  44,  43,  45, // Rank 8
-    -24, -39,  -5,   1, -16,  57,  28,  54, // Rank 7
-    -13, -17,   7,   8,  29,  56,  47,  57, // Rank 6
-    -27, -27, -16, -16,  -1,  17,  -2,   1, // Rank 5
-     -9, -26,  -9, -10,  -2,  -4,   3,  -3, // Rank 4
-    -14,   2, -11,  -2,  -5,   2,  14,   5, // Rank 3
-    -35,  -8,  11,   2,   8,  15,  -3,   1, // Rank 2
-     -1, -18,  -9,  10, -15, -25, -31, -50  // Rank 1
-};
+    limited = true;
+    int64_t usable = std::max<int64_t>(1, time_left - limits.move_overhead);
+    int moves_to_go = (limits.movestogo > 0) ? std::min(limits.movestogo, 40) : 30;
 
-const int PST_KING[64] = {
-    -65,  23,  16, -15, -56, -34,   2,  13, // Rank 8
-     29,  -1, -20,  -7,  -8,  -4, -38, -29, // Rank 7
-     -9,  24,   2, -16, -20,   6,  22, -22, // Rank 6
-    -17, -20, -12, -27, -30, -25, -14, -36, // Rank 5
-    -49,  -1, -27, -39, -46, -44, -33, -51, // Rank 4
-    -14, -14, -22, -46, -44, -30, -15, -27, // Rank 3
-      1,   7,  -8, -64, -43, -16,   9,   8, // Rank 2
-    -15,  36,  12, -54,  -8, -28,  24,  14  // Rank 1
-};
+    int64_t optimum = usable / moves_to_go + (int64_t)inc * 3 / 4;
+    hard_ms = std::max<int64_t>(1, std::min(usable * 4 / 5, optimum * 5));
+    soft_ms = std::max<int64_t>(1, std::min(optimum, hard_ms));
+}
 
-const int* PST_TABLES[6] = {
-    PST_PAWN,
-    PST_KNIGHT,
-    PST_BISHOP,
-    PST_ROOK,
-    PST_QUEEN,
-    PST_KING
-};
-    ChessEngine::ChessEngine() : rng(std::chrono::steady_clock::now().time_since_epoch().count()), last_eval_score(0) {
+int64_t TimeManager::elapsed_ms() const {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool TimeManager::should_stop_iterating(const Move& best_move) {
+    if (best_move == last_best) stability = std::min(stability + 1, 4);
+    else stability = 0;
+    last_best = best_move;
+
+    if (!limited) return false;
+    if (fixed_time) return elapsed_ms() >= hard_ms;
+
+    // Lance instável -> estende o soft limit; lance estável -> encerra antes
+    static const int STABILITY_SCALE[5] = { 200, 130, 100, 75, 55 }; // Percentual
+    return elapsed_ms() >= soft_ms * STABILITY_SCALE[stability] / 100;
+}
+
+// --- TT COMPARTILHADA ---
+TTPool& TTPool::instance() {
+    static TTPool* pool = new TTPool(); // Nunca destruído: engines globais podem soltar tabelas depois
+    return *pool;
+}
+
+void TTPool::set_budget(size_t size_mb) {
+    std::lock_guard<std::mutex> lock(mutex);
+    budget = size_mb;
+}
+
+size_t TTPool::budget_mb() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return budget;
+}
+
+size_t TTPool::used_mb() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return used;
+}
+
+// O orçamento é reservado com o mutex travado; a tabela é alocada e zerada
+// fora dele, para engines criadas juntas não esperarem umas pelas outras
+std::shared_ptr<TranspositionTable> TTPool::acquire(size_t size_mb) {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        size_t room = budget ? (budget > used ? budget - used : 0) : std::max<size_t>(1, size_mb);
+        if (room > 0) {
+            size_mb = std::max<size_t>(1, std::min(size_mb, room));
+            used += size_mb;
+            break;
+        }
+        // Orçamento esgotado: compartilha a tabela do pool ou outra ainda viva
+        std::shared_ptr<TranspositionTable> table = shared_table.lock();
+        for (size_t i = 0; !table && i < tables.size(); i++) table = tables[i].lock();
+        if (table) {
+            shared_table = table;
+            return table;
+        }
+        changed.wait(lock); // Reservas ainda sendo zeradas ou tabelas sendo devolvidas
+    }
+    lock.unlock();
+
+    // O deleter devolve a memória ao orçamento
+    std::shared_ptr<TranspositionTable> table(new TranspositionTable(size_mb), [this](TranspositionTable* t) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            used -= t->size_mb();
+        }
+        changed.notify_all();
+        delete t;
+    });
+
+    lock.lock();
+    tables.erase(std::remove_if(tables.begin(), tables.end(), [](const std::weak_ptr<TranspositionTable>& t) { return t.expired(); }),
+                 tables.end());
+    tables.push_back(table);
+    lock.unlock();
+    changed.notify_all();
+    return table;
+}
+
+std::shared_ptr<TranspositionTable> TTPool::shared(size_t size_mb) {
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [this] { return !creating_shared; });
+    std::shared_ptr<TranspositionTable> table = shared_table.lock();
+    if (table) return table;
+
+    creating_shared = true;
+    lock.unlock();
+    table = acquire(size_mb);
+    lock.lock();
+    shared_table = table;
+    creating_shared = false;
+    lock.unlock();
+    changed.notify_all();
+    return table;
+}
+
+// --- ESTADO DA BUSCA ---
+void SearchThread::reset_search_stack() {
+    for (int i = 0; i < MAX_PLY + 4; i++) {
+        search_stack[i].current_move = Move();
+        search_stack[i].moved_piece = -1;
+        search_stack[i].static_eval = NO_EVAL;
+        search_stack[i].killers[0] = Move();
+        search_stack[i].killers[1] = Move();
+        search_stack[i].cont_history = &continuation_history.back();
+    }
+}
+
+void SearchThread::clear_history() {
     std::memset(history_moves, 0, sizeof(history_moves));
-    for(int i=0; i<20; i++) { killer_moves[i][0] = Move(); killer_moves[i][1] = Move(); }
-    tt.clear(); 
+    for (auto& row : counter_moves) std::fill(std::begin(row), std::end(row), Move());
+    // Última entrada é a sentinela usada pelos plies sem lance anterior
+    continuation_history.assign(12 * 64 + 1, PieceToHistory{});
+    reset_search_stack();
+}
+
+// Divide as tabelas por 2 entre lances: preserva o conhecimento da busca
+// anterior sem deixar que ele domine a próxima
+void SearchThread::age_history() {
+    for (auto& color : history_moves)
+        for (auto& from : color)
+            for (int& h : from) h /= 2;
+    for (auto& table : continuation_history)
+        for (auto& piece : table)
+            for (int16_t& h : piece) h /= 2;
+}
+
+ChessEngine::ChessEngine() : rng(std::chrono::steady_clock::now().time_since_epoch().count()), last_eval_score(0) {
+    stop_search = false;
+    stop_received = false;
+    ponder_hit = false;
+    searching = false;
+    silent = false;
+    book_best_move = false;
+    tb_probe_limit = 7;
+    tb_probe_depth = 1;
+    multi_pv = 1;
+    thread_count = 1;
+    hash_mb = 64;
+    eval_cache_mb = 4;
+}
+
+bool ChessEngine::load_book(const std::string& path) {
+    auto new_book = std::make_shared<PolyglotBook>();
+    if (!new_book->open(path)) return false;
+    book = new_book;
+    return true;
+}
+
+bool ChessEngine::load_network(const std::string& path) {
+    auto net = std::make_shared<NNUENetwork>();
+    if (!net->load(path)) return false;
+    set_network(net);
+    return true;
+}
+
+void ChessEngine::set_network(std::shared_ptr<NNUENetwork> net) {
+    network = std::move(net);
+    if (main_thread) main_thread->eval_cache.clear(); // Valores antigos vinham da outra avaliação
+    for (auto& helper : helpers) helper->eval_cache.clear();
+}
+
+void ChessEngine::set_eval_cache_size(size_t size_mb) {
+    eval_cache_mb = size_mb;
+    if (main_thread) main_thread->eval_cache.resize(size_mb);
+    for (auto& helper : helpers) helper->eval_cache.resize(size_mb);
+}
+
+// Os helpers são criados na próxima busca
+void ChessEngine::set_threads(int count) {
+    thread_count = std::max(1, count);
+    if (helpers.size() > (size_t)thread_count - 1) helpers.resize(thread_count - 1);
+}
+
+const SearchStats& ChessEngine::get_search_stats() const {
+    static const SearchStats empty;
+    return main_thread ? main_thread->stats : empty;
+}
+
+int ChessEngine::evaluate(SearchThread& th, const ChessBoard& board, int ply) const {
+    int eval;
+    if (th.eval_cache.probe(board.get_hash(), eval)) return eval;
+
+    if (network) {
+        eval = network->evaluate(th.nnue_stack[ply], board.get_side_to_move());
+    } else {
+        eval = evaluate_material(board, &th.pawn_table);
+        if (board.get_side_to_move() == BLACK) eval = -eval;
+    }
+    th.eval_cache.store(board.get_hash(), eval);
+    return eval;
+}
+
+void ChessEngine::make_search_move(SearchThread& th, ChessBoard& board, const Move& move, int ply) const {
+    board.make_move_internal(move); // Lances vêm dos geradores legais; sem revalidar
+    if (network) network->update(th.nnue_stack[ply], th.nnue_stack[ply + 1], board.get_dirty_pieces());
 }
 
 inline int count_bits(uint64_t n) { return __builtin_popcountll(n); }
+inline Square lsb(Bitboard bb) { return bb ? __builtin_ctzll(bb) : NO_SQUARE; }
+
+// --- HISTÓRICO ---
+void ChessEngine::new_game() {
+    if (tt && tt.use_count() == 1) tt->clear(); // Tabela compartilhada: as outras partidas continuam usando
+    clear_history();
+}
+
+void ChessEngine::clear_history() {
+    if (main_thread) main_thread->clear_history();
+    for (auto& helper : helpers) helper->clear_history();
+}
+
+// Atualização com "gravidade": converge para +-HISTORY_MAX sem estourar
+inline void apply_history_bonus(int& entry, int bonus) {
+    entry += bonus - entry * std::abs(bonus) / HISTORY_MAX;
+}
+inline void apply_history_bonus(int16_t& entry, int bonus) {
+    entry += bonus - entry * std::abs(bonus) / HISTORY_MAX;
+}
+
+void ChessEngine::update_quiet_history(SearchThread& th, SearchStackEntry* ss, Color side, const Move& move, int piece, int bonus) const {
+    apply_history_bonus(th.history_moves[side][move.from][move.to], bonus);
+    if ((ss - 1)->moved_piece >= 0) apply_history_bonus((*(ss - 1)->cont_history)[piece][move.to], bonus);
+    if ((ss - 2)->moved_piece >= 0) apply_history_bonus((*(ss - 2)->cont_history)[piece][move.to], bonus);
+}
 
 // --- ORDENAÇÃO ---
-void ChessEngine::order_moves(const ChessBoard& board, std::vector<Move>& moves, int ply, const Move& tt_move) const {
-    std::sort(moves.begin(), moves.end(), [&](const Move& a, const Move& b) {
-        int score_a = 0, score_b = 0;
-        
-        // 1. TT Move 
-        if (tt_move.from != 64 && a == tt_move) return true; 
-        if (tt_move.from != 64 && b == tt_move) return false;
-
-        // Avaliar A
-        PieceType victim_a = board.get_piece(a.to);
-        if (victim_a != NONE) {
-            score_a = 20000 + (PIECE_VALUES[victim_a] * 10) - PIECE_VALUES[board.get_piece(a.from)];
-        } else {
-            if (ply < 20) {
-                if (a == killer_moves[ply][0]) score_a = 19000;
-                else if (a == killer_moves[ply][1]) score_a = 18000;
-            }
-            if (score_a == 0 && a.from < 64 && a.to < 64) score_a = std::min(history_moves[a.from][a.to], 15000);
-        }
+const int SCORE_TT_MOVE = 1000000;
+const int SCORE_CAPTURE = 20000;
+
+void ChessEngine::score_moves(SearchThread& th, const ChessBoard& board, MovePicker& picker, const std::vector<Move>& moves, int ply, const Move& tt_move) const {
+    const SearchStackEntry* ss = th.stack_at(ply);
+    Color side = board.get_side_to_move();
+    Move counter_move;
+    if ((ss - 1)->moved_piece >= 0) counter_move = th.counter_moves[(ss - 1)->moved_piece][(ss - 1)->current_move.to];
 
-        // Avaliar B
-        PieceType victim_b = board.get_piece(b.to);
-        if (victim_b != NONE) {
-            score_b = 20000 + (PIECE_VALUES[victim_b] * 10) - PIECE_VALUES[board.get_piece(b.from)];
+    int* scores = picker.score_table();
+    for (size_t i = 0; i < moves.size(); i++) {
+        const Move& m = moves[i];
+        if (tt_move.from != NO_SQUARE && m == tt_move) { scores[i] = SCORE_TT_MOVE; continue; }
+
+        PieceType attacker = board.get_piece(m.from);
+        PieceType victim = board.get_piece(m.to);
+        if (victim != NONE) {
+            scores[i] = SCORE_CAPTURE + (PIECE_VALUES[victim] * 10) - PIECE_VALUES[attacker];
+        } else if (m == ss->killers[0]) {
+            scores[i] = 19000;
+        } else if (m == ss->killers[1]) {
+            scores[i] = 18000;
+        } else if (m == counter_move) {
+            scores[i] = 17000;
         } else {
-            if (ply < 20) {
-                if (b == killer_moves[ply][0]) score_b = 19000;
-                else if (b == killer_moves[ply][1]) score_b = 18000;
-            }
-            if (score_b == 0 && b.from < 64 && b.to < 64) score_b = std::min(history_moves[b.from][b.to], 15000);
+            int piece = side * 6 + attacker;
+            int score = th.history_moves[side][m.from][m.to]
+                      + (*(ss - 1)->cont_history)[piece][m.to]
+                      + (*(ss - 2)->cont_history)[piece][m.to];
+            scores[i] = std::min(score, 15000);
         }
-        return score_a > score_b;
-    });
+    }
 }
 
-void ChessEngine::order_moves_simple(const ChessBoard& board, std::vector<Move>& moves) const {
-     std::sort(moves.begin(), moves.end(), [&](const Move& a, const Move& b) {
-        int score_a = 0, score_b = 0;
-        if (board.get_piece(a.to) != NONE) score_a = 10000 + PIECE_VALUES[board.get_piece(a.to)];
-        if (board.get_piece(b.to) != NONE) score_b = 10000 + PIECE_VALUES[board.get_piece(b.to)];
-        return score_a > score_b;
-    });
+// Quiescência: MVV-LVA para capturas (promoções contam o ganho de material);
+// lances quietos (só aparecem nas evasões de xeque) ficam negativos e
+// são sempre escolhidos por último
+void ChessEngine::score_captures(const ChessBoard& board, MovePicker& picker, const std::vector<Move>& moves) const {
+    int* scores = picker.score_table();
+    for (size_t i = 0; i < moves.size(); i++) {
+        const Move& m = moves[i];
+        PieceType victim = m.is_en_passant ? PAWN : board.get_piece(m.to);
+        if (victim == NONE && m.promotion == NONE) { scores[i] = -1; continue; }
+        int gain = (victim == NONE ? 0 : PIECE_VALUES[victim]);
+        if (m.promotion != NONE) gain += PIECE_VALUES[m.promotion] - PIECE_VALUES[PAWN];
+        scores[i] = SCORE_CAPTURE + gain * 10 - PIECE_VALUES[board.get_piece(m.from)];
+    }
 }
 
-int ChessEngine::eval_pawns(const ChessBoard& board) const{
+// Algoritmo de swap: alterna os lados recapturando sempre com o atacante de
+// menor valor e revelando peças deslizantes por trás (raios-x)
+bool ChessEngine::see_ge(const ChessBoard& board, const Move& move, int threshold) const {
+    Square to = move.to;
+    PieceType victim = move.is_en_passant ? PAWN : board.get_piece(to);
+    int swap = (victim == NONE ? 0 : PIECE_VALUES[victim]) - threshold;
+    if (swap < 0) return false;
+    swap = PIECE_VALUES[board.get_piece(move.from)] - swap;
+    if (swap <= 0) return true;
 
-};
+    Bitboard occupied = board.all_pieces ^ (1ULL << move.from) ^ (1ULL << to);
+    if (move.is_en_passant) occupied ^= 1ULL << (board.side_to_move == WHITE ? to - 8 : to + 8);
 
+    Bitboard bishops = board.pieces_white[BISHOP] | board.pieces_black[BISHOP] | board.pieces_white[QUEEN] | board.pieces_black[QUEEN];
+    Bitboard rooks = board.pieces_white[ROOK] | board.pieces_black[ROOK] | board.pieces_white[QUEEN] | board.pieces_black[QUEEN];
+    Bitboard attackers = board.attackers_to(to, occupied);
+    Color stm = board.side_to_move;
+    bool result = true;
 
+    while (true) {
+        stm = (stm == WHITE) ? BLACK : WHITE;
+        attackers &= occupied;
+        const auto& pieces = (stm == WHITE) ? board.pieces_white : board.pieces_black;
+        Bitboard stm_attackers = attackers & ((stm == WHITE) ? board.all_white : board.all_black);
+        if (!stm_attackers) break;
+        result = !result;
 
-int ChessEngine::evaluate_material(const ChessBoard& board) const {
-    int score = 0;
-    for (int sq = 0; sq < 64; sq++) {
-        PieceType piece = board.get_piece(sq);
-        if (piece != NONE) {
-            Color color = board.get_piece_color(sq);
-            int value = PIECE_VALUES[piece];
-            if (piece != KING) {
-                int pst_idx = (color == WHITE) ? sq : (sq ^ 56);
-                value += PST_TABLES[piece][pst_idx];
-                if (piece != PAWN) {
-                    Bitboard attacks = board.get_attacks_by(sq, piece, color);
-                    value += count_bits(attacks) * MOBILITY_BONUS[piece];
+        int pt = PAWN;
+        while (pt < KING && !(stm_attackers & pieces[pt])) pt++;
+        // O rei só pode recapturar se o adversário não tiver mais atacantes
+        if (pt == KING) return (attackers & ~stm_attackers) ? !result : result;
+
+        swap = PIECE_VALUES[pt] - swap;
+        if (swap < (int)result) break;
+        occupied ^= 1ULL << lsb(stm_attackers & pieces[pt]);
+        if (pt == PAWN || pt == BISHOP || pt == QUEEN) attackers |= board.get_bishop_attacks(to, occupied) & bishops;
+        if (pt == ROOK || pt == QUEEN) attackers |= board.get_rook_attacks(to, occupied) & rooks;
+    }
+    return result;
+}
+
+// --- ESTRUTURA DE PEÕES ---
+// Máscaras pré-calculadas para os termos de peões
+struct PawnMasks {
+    Bitboard file[8];
+    Bitboard adjacent_files[8];
+    Bitboard forward_file[2][64];    // Casas à frente na mesma coluna
+    Bitboard passed[2][64];          // Casas à frente na coluna e adjacentes
+    Bitboard behind_adjacent[2][64]; // Colunas adjacentes, mesmo rank ou atrás
+
+    PawnMasks() {
+        for (int f = 0; f < 8; f++) {
+            file[f] = 0x0101010101010101ULL << f;
+        }
+        for (int f = 0; f < 8; f++) {
+            adjacent_files[f] = (f > 0 ? file[f - 1] : 0) | (f < 7 ? file[f + 1] : 0);
+        }
+        for (int sq = 0; sq < 64; sq++) {
+            int r = ChessBoard::get_rank(sq), f = ChessBoard::get_file(sq);
+            for (int c = 0; c < 2; c++) {
+                Bitboard ahead = 0, behind = 0;
+                for (int nr = 0; nr < 8; nr++) {
+                    Bitboard rank_bb = 0xFFULL << (8 * nr);
+                    bool is_ahead = (c == WHITE) ? nr > r : nr < r;
+                    if (is_ahead) ahead |= rank_bb; else behind |= rank_bb;
                 }
+                forward_file[c][sq] = ahead & file[f];
+                passed[c][sq] = ahead & (file[f] | adjacent_files[f]);
+                behind_adjacent[c][sq] = behind & adjacent_files[f];
             }
-            score += (color == WHITE) ? value : -value;
         }
     }
+};
+static const PawnMasks PAWN_MASKS;
+
+// Termos que dependem só dos peões: passados, isolados, dobrados e atrasados.
+// Contagens de uma cor; a avaliação e o trace do tuner usam as mesmas regras.
+void ChessEngine::count_pawn_terms(const ChessBoard& board, Color us, PawnTerms& terms) {
+    terms = PawnTerms();
+    Bitboard own = (us == WHITE) ? board.pieces_white[PAWN] : board.pieces_black[PAWN];
+    Bitboard enemy = (us == WHITE) ? board.pieces_black[PAWN] : board.pieces_white[PAWN];
+
+    Bitboard pawns = own;
+    while (pawns) {
+        Square sq = lsb(pawns);
+        pawns &= pawns - 1;
+        int file = ChessBoard::get_file(sq);
+        int rel_rank = (us == WHITE) ? ChessBoard::get_rank(sq) : 7 - ChessBoard::get_rank(sq);
+        bool isolated = (own & PAWN_MASKS.adjacent_files[file]) == 0;
+        bool doubled = (own & PAWN_MASKS.forward_file[us][sq]) != 0;
+
+        if (isolated) terms.isolated++;
+        if (doubled) terms.doubled++;
+
+        if (!doubled && (enemy & PAWN_MASKS.passed[us][sq]) == 0) {
+            terms.passed[rel_rank]++;
+        } else if (!isolated && (own & PAWN_MASKS.behind_adjacent[us][sq]) == 0) {
+            // Atrasado: sem apoio possível e a casa de avanço é controlada por peão inimigo
+            Square stop = sq + ((us == WHITE) ? 8 : -8);
+            if (board.get_pawn_attacks(stop, us) & enemy) terms.backward++;
+        }
+    }
+}
+
+// O resultado fica na pawn hash table da thread, indexada pela chave dos peões.
+void ChessEngine::eval_pawns(const ChessBoard& board, PawnHashTable* pawn_cache, int& mg, int& eg) const {
+    bool found = false;
+    PawnEntry* entry = pawn_cache ? &pawn_cache->probe(board.get_pawn_hash(), found) : nullptr;
+    if (found) { mg = entry->mg; eg = entry->eg; return; }
+
+    mg = eg = 0;
+    for (int c = 0; c < 2; c++) {
+        PawnTerms terms;
+        count_pawn_terms(board, (Color)c, terms);
+        int side_mg = terms.isolated * ISOLATED_MG + terms.doubled * DOUBLED_MG + terms.backward * BACKWARD_MG;
+        int side_eg = terms.isolated * ISOLATED_EG + terms.doubled * DOUBLED_EG + terms.backward * BACKWARD_EG;
+        for (int r = 0; r < 8; r++) {
+            side_mg += terms.passed[r] * PASSED_MG[r];
+            side_eg += terms.passed[r] * PASSED_EG[r];
+        }
+        int sign = (c == WHITE) ? 1 : -1;
+        mg += sign * side_mg;
+        eg += sign * side_eg;
+    }
+
+    if (!entry) return;
+    entry->key = board.get_pawn_hash();
+    entry->mg = mg;
+    entry->eg = eg;
+}
+
+// Escudo de peões na frente do rei (termo de meio-jogo, depende do rei,
+// por isso fica fora da pawn hash table)
+void ChessEngine::count_shield_terms(const ChessBoard& board, Color c, ShieldTerms& terms) {
+    terms = ShieldTerms();
+    Bitboard king = (c == WHITE) ? board.pieces_white[KING] : board.pieces_black[KING];
+    if (!king) return;
+    Square ksq = lsb(king);
+    int rel_rank = (c == WHITE) ? ChessBoard::get_rank(ksq) : 7 - ChessBoard::get_rank(ksq);
+    if (rel_rank > 1) return; // Rei fora da primeira fila: sem escudo
+
+    Bitboard own = (c == WHITE) ? board.pieces_white[PAWN] : board.pieces_black[PAWN];
+    int kf = ChessBoard::get_file(ksq);
+    for (int f = std::max(0, kf - 1); f <= std::min(7, kf + 1); f++) {
+        int near_rank = (c == WHITE) ? rel_rank + 1 : 6 - rel_rank;
+        int far_rank = (c == WHITE) ? rel_rank + 2 : 5 - rel_rank;
+        if (own & (1ULL << ChessBoard::make_square(f, near_rank))) terms.shield_near++;
+        else if (own & (1ULL << ChessBoard::make_square(f, far_rank))) terms.shield_far++;
+        else terms.shield_missing++;
+    }
+}
+
+int ChessEngine::eval_pawn_shield(const ChessBoard& board, Color c) const {
+    ShieldTerms terms;
+    count_shield_terms(board, c, terms);
+    return terms.shield_near * SHIELD_NEAR + terms.shield_far * SHIELD_FAR + terms.shield_missing * SHIELD_MISSING;
+}
+
+// Casas atacadas (dentro de MOBILITY_AREA) somadas por tipo de peça, para
+// percorrer os bitboards de cada tipo em vez de varrer as 64 casas
+void ChessEngine::count_mobility(const ChessBoard& board, Color c, int attacks[6]) {
+    const auto& pieces = (c == WHITE) ? board.pieces_white : board.pieces_black;
+    Bitboard occupied = board.all_pieces;
+    Bitboard area = MOBILITY_AREA[c];
+    for (int pt = 0; pt < 6; pt++) attacks[pt] = 0;
+
+    for (Bitboard bb = pieces[KNIGHT]; bb; bb &= bb - 1)
+        attacks[KNIGHT] += count_bits(board.get_knight_attacks(lsb(bb)) & area);
+    for (Bitboard bb = pieces[BISHOP]; bb; bb &= bb - 1)
+        attacks[BISHOP] += count_bits(board.get_bishop_attacks(lsb(bb), occupied) & area);
+    for (Bitboard bb = pieces[ROOK]; bb; bb &= bb - 1)
+        attacks[ROOK] += count_bits(board.get_rook_attacks(lsb(bb), occupied) & area);
+    for (Bitboard bb = pieces[QUEEN]; bb; bb &= bb - 1)
+        attacks[QUEEN] += count_bits(board.get_queen_attacks(lsb(bb), occupied) & area);
+}
+
+int ChessEngine::evaluate_material(const ChessBoard& board, PawnHashTable* pawn_cache) const {
+    // Material + PST (somas incrementais do tabuleiro) + estrutura de peões,
+    // interpolados pela fase do jogo (meio-jogo -> final)
+    int pawn_mg, pawn_eg;
+    eval_pawns(board, pawn_cache, pawn_mg, pawn_eg);
+    int mg = board.get_mg_score() + pawn_mg + eval_pawn_shield(board, WHITE) - eval_pawn_shield(board, BLACK);
+    int eg = board.get_eg_score() + pawn_eg;
+
+    int phase = std::min(board.get_game_phase(), MAX_PHASE);
+    int score = (mg * phase + eg * (MAX_PHASE - phase)) / MAX_PHASE;
+
+    // Mobilidade (sem interpolação de fase)
+    for (int c = 0; c < 2; c++) {
+        int attacks[6];
+        count_mobility(board, (Color)c, attacks);
+        int mobility = 0;
+        for (int pt = KNIGHT; pt <= QUEEN; pt++) mobility += attacks[pt] * MOBILITY_BONUS[pt];
+        score += (c == WHITE) ? mobility : -mobility;
+    }
     return score;
 }
 
-int ChessEngine::quiescence(ChessBoard& board, int alpha, int beta, int depth_left) const {
+void ChessEngine::trace_evaluation(const ChessBoard& board, EvalTrace& trace) const {
+    trace = EvalTrace();
+    trace.phase = std::min(board.get_game_phase(), MAX_PHASE);
+    for (int c = 0; c < 2; c++) {
+        const auto& pieces = (c == WHITE) ? board.pieces_white : board.pieces_black;
+        int sign = (c == WHITE) ? 1 : -1;
+        for (int pt = PAWN; pt <= KING; pt++) {
+            for (Bitboard bb = pieces[pt]; bb; bb &= bb - 1) {
+                Square sq = lsb(bb);
+                trace.material[pt] += sign;
+                trace.pst[pt][(c == WHITE) ? (sq ^ 56) : sq] += sign; // Layout PeSTO
+            }
+        }
+
+        PawnTerms pawns;
+        count_pawn_terms(board, (Color)c, pawns);
+        for (int r = 0; r < 8; r++) trace.pawns.passed[r] += sign * pawns.passed[r];
+        trace.pawns.isolated += sign * pawns.isolated;
+        trace.pawns.doubled += sign * pawns.doubled;
+        trace.pawns.backward += sign * pawns.backward;
+
+        ShieldTerms shield;
+        count_shield_terms(board, (Color)c, shield);
+        trace.shield.shield_near += sign * shield.shield_near;
+        trace.shield.shield_far += sign * shield.shield_far;
+        trace.shield.shield_missing += sign * shield.shield_missing;
+
+        int attacks[6];
+        count_mobility(board, (Color)c, attacks);
+        for (int pt = PAWN; pt <= KING; pt++) trace.mobility[pt] += sign * attacks[pt];
+    }
+}
+
+void ChessEngine::check_time(SearchThread& th) {
+    th.published_nodes.store(th.stats.nodes, std::memory_order_relaxed);
+    th.next_check = th.stats.nodes + TIME_CHECK_NODES;
+    // "go nodes" conta os nós de todas as threads (helpers não têm limite próprio);
+    // a próxima checagem cai em cima do limite, e depois dele vale a cada nó
+    uint64_t searched = th.node_limit ? th.stats.nodes + helper_nodes() : 0;
+    if (th.node_limit) {
+        uint64_t left = searched < th.node_limit ? th.node_limit - searched : 1;
+        th.next_check = std::min(th.next_check, th.stats.nodes + left);
+    }
+    check_ponderhit(th);
+    // A primeira iteração sempre termina, para nunca devolver um lance aleatório
+    if (th.pondering || th.root_depth <= 1) return;
+    if (th.time_manager.hard_limit_reached() || (th.node_limit && searched >= th.node_limit)) stop_search = true;
+}
+
+uint64_t ChessEngine::helper_nodes() const {
+    uint64_t nodes = 0;
+    for (const auto& helper : helpers) nodes += helper->published_nodes.load(std::memory_order_relaxed);
+    return nodes;
+}
+
+void ChessEngine::check_ponderhit(SearchThread& th) {
+    if (th.pondering && ponder_hit) {
+        th.pondering = false;
+        th.time_manager.restart();
+    }
+}
+
+// PV deste ply = move + PV do filho
+void ChessEngine::update_pv(SearchThread& th, int ply, const Move& move) const {
+    th.pv_table[ply][ply] = move;
+    for (int i = ply + 1; i < th.pv_length[ply + 1]; i++) th.pv_table[ply][i] = th.pv_table[ply + 1][i];
+    th.pv_length[ply] = std::max(th.pv_length[ply + 1], ply + 1);
+}
+
+int ChessEngine::mate_in(int score) {
+    if (std::abs(score) <= MATE_SCORE - MAX_PLY) return 0;
+    int moves = (MATE_SCORE - std::abs(score) + 1) / 2;
+    return score > 0 ? moves : -moves;
+}
+
+int ChessEngine::score_to_cp(int score) {
+    int distance = TB_WIN_SCORE - std::abs(score);
+    if (distance < 0 || distance >= MAX_PLY) return score;
+    return score > 0 ? TB_WIN_CP - distance : -TB_WIN_CP + distance;
+}
+
+void ChessEngine::print_info(const SearchStats& stats, const std::vector<PVLine>& lines) const {
+    if (silent) return;
+    std::ostringstream out;
+    for (size_t i = 0; i < lines.size(); i++) {
+        out << "info depth " << stats.depth << " seldepth " << stats.seldepth << " multipv " << i + 1;
+        if (int mate = mate_in(lines[i].score)) {
+            out << " score mate " << mate;
+        } else {
+            out << " score cp " << score_to_cp(lines[i].score);
+        }
+        out << " nodes " << stats.nodes << " nps " << stats.nps << " hashfull " << stats.hashfull << " tbhits " << stats.tbhits
+            << " time " << stats.time_ms << " pv";
+        for (const Move& m : lines[i].pv) out << " " << m.to_string();
+        out << '\n';
+    }
+    std::cout << out.str() << std::flush;
+}
+
+int ChessEngine::quiescence(SearchThread& th, ChessBoard& board, int alpha, int beta, int depth_left, int ply) {
     if (stop_search) return 0;
-    int eval = evaluate_material(board);
-    if (board.get_side_to_move() == BLACK) eval = -eval;
-    if (depth_left <= 0) return eval;
-    if (eval >= beta) return beta;
-    if (eval > alpha) alpha = eval;
+    if (++th.stats.nodes >= th.next_check) {
+        check_time(th);
+        if (stop_search) return 0;
+    }
+    th.stats.qnodes++;
+    th.pv_length[ply] = ply; // A quiescência não estende a PV
+    if (ply + 1 > th.stats.seldepth) th.stats.seldepth = ply + 1;
+    bool in_check = board.is_check(board.get_side_to_move());
+    if (depth_left <= 0 || ply >= MAX_PLY - 1) return evaluate(th, board, ply);
 
-    std::vector<Move> moves = board.generate_legal_moves();
-    order_moves_simple(board, moves);
+    // Em xeque não existe "stand pat": todas as evasões são buscadas
+    int eval = -INFINITY_SCORE;
+    std::vector<Move> moves;
+    if (in_check) {
+        moves = board.generate_legal_moves();
+        if (moves.empty()) return -MATE_SCORE + ply;
+    } else {
+        eval = evaluate(th, board, ply);
+        if (eval >= beta) return beta;
+        if (eval > alpha) alpha = eval;
+        moves = board.generate_legal_captures();
+    }
+
+    MovePicker picker(moves);
+    score_captures(board, picker, moves);
 
-    for (const Move& move : moves) {
-        if (board.get_piece(move.to) == NONE) continue;
-        board.make_move(move);
-        int score = -quiescence(board, -beta, -alpha, depth_left - 1);
+    Move move;
+    int move_score;
+    while (picker.next(move, &move_score)) {
+        if (!in_check) {
+            PieceType victim = move.is_en_passant ? PAWN : board.get_piece(move.to);
+            int gain = (victim == NONE ? 0 : PIECE_VALUES[victim]);
+            if (move.promotion != NONE) gain += PIECE_VALUES[move.promotion] - PIECE_VALUES[PAWN];
+            // Delta pruning: nem o material ganho com folga alcança alpha
+            if (eval + gain + QS_DELTA_MARGIN <= alpha) continue;
+            // Capturas perdedoras pelo SEE não mudam o resultado
+            if (move.promotion == NONE && !see_ge(board, move, 0)) continue;
+        }
+        make_search_move(th, board, move, ply);
+        int score = -quiescence(th, board, -beta, -alpha, depth_left - 1, ply + 1);
         board.unmake_move();
         if (stop_search) return 0;
         if (score >= beta) return beta;
@@ -199,22 +679,50 @@ int ChessEngine::quiescence(ChessBoard& board, int alpha, int beta, int depth_le
     return alpha;
 }
 
-int ChessEngine::negamax(ChessBoard& board, int depth, int ply, int alpha, int beta) const {
-    if ((ply & 2047) == 0) { 
-        auto now = std::chrono::steady_clock::now();
-        if (std::chrono::duration_cast<std::chrono::milliseconds>(now - start_time).count() > TIME_LIMIT_MS) stop_search = true;
-    }
+template <NodeType NT>
+int ChessEngine::negamax(SearchThread& th, ChessBoard& board, int depth, int ply, int alpha, int beta) {
+    constexpr bool PV_NODE = (NT == NODE_PV);
     if (stop_search) return 0;
+    if (++th.stats.nodes >= th.next_check) {
+        check_time(th);
+        if (stop_search) return 0;
+    }
+    if (PV_NODE) {
+        th.pv_length[ply] = ply;
+        if (ply + 1 > th.stats.seldepth) th.stats.seldepth = ply + 1;
+    }
 
-    int tt_score; Move tt_move;
-    if (tt.probe(board.get_hash(), depth, alpha, beta, tt_score, tt_move)) {
-        if (ply > 0) return tt_score; 
+    // Nós PV não cortam pela TT: a linha principal sempre vem da busca
+    TTData tt_data; Move tt_move;
+    th.stats.tt_probes++;
+    if (tt->probe(board.get_hash(), tt_data)) {
+        th.stats.tt_hits++;
+        tt_move = tt_data.best_move; // Sempre útil para ordenação
+        int tt_score;
+        if (!PV_NODE && tt_data.cutoff(depth, alpha, beta, tt_score)) return tt_score;
     }
 
     Color side = board.get_side_to_move();
     bool in_check = board.is_check(side);
 
-    if (depth <= 0) return quiescence(board, alpha, beta, 4);
+    // Tablebases: resultado exato assim que o material cabe nas tabelas
+    if (th.tb_cardinality > 0 && depth >= tb_probe_depth && count_bits(board.all_pieces) <= th.tb_cardinality) {
+        SyzygyWDL wdl;
+        if (SyzygyTablebases::probe_wdl(board, wdl)) {
+            th.stats.tbhits++;
+            int score = (wdl == TB_WDL_WIN) ? TB_WIN_SCORE - ply : (wdl == TB_WDL_LOSS) ? -TB_WIN_SCORE + ply : 0;
+            tt->store(board.get_hash(), depth, score, TT_EXACT, Move());
+            return score;
+        }
+    }
+
+    if (depth <= 0) return quiescence(th, board, alpha, beta, 4, ply);
+
+    SearchStackEntry* ss = th.stack_at(ply);
+    if (ply >= MAX_PLY - 1) {
+        return evaluate(th, board, ply);
+    }
+    ss->static_eval = NO_EVAL; // Preenchida apenas quando a avaliação já está disponível
 
     std::vector<Move> moves = board.generate_legal_moves();
     if (moves.empty()) {
@@ -222,22 +730,36 @@ int ChessEngine::negamax(ChessBoard& board, int depth, int ply, int alpha, int b
         return 0; 
     }
 
-    order_moves(board, moves, ply, tt_move);
+    MovePicker picker(moves);
+    score_moves(th, board, picker, moves, ply, tt_move);
 
     int moves_searched = 0;
     int lmp_limit = 5 + (depth * depth);
-    auto* non_const_this = const_cast<ChessEngine*>(this);
 
     int best_val = -INFINITY_SCORE;
     Move best_move_this_node;
     TTFlag flag = TT_ALPHA;
 
-    for (const Move& move : moves) {
+    Move move;
+    while (picker.next(move)) {
         bool is_capture = (board.get_piece(move.to) != NONE);
-        if (!in_check && depth <= 3 && !is_capture && moves_searched > lmp_limit) { continue; }
+        // LMP só em nós de janela nula: em nós PV todo lance pode virar a linha principal
+        if (!PV_NODE && !in_check && depth <= 3 && !is_capture && moves_searched > lmp_limit) { continue; }
+
+        int piece = side * 6 + board.get_piece(move.from);
+        ss->current_move = move;
+        ss->moved_piece = piece;
+        ss->cont_history = &th.continuation_history[piece * 64 + move.to];
 
-        board.make_move(move);
-        int score = -negamax(board, depth - 1, ply + 1, -beta, -alpha);
+        make_search_move(th, board, move, ply);
+        int score;
+        if (PV_NODE && moves_searched == 0) {
+            score = -negamax<NODE_PV>(th, board, depth - 1, ply + 1, -beta, -alpha);
+        } else {
+            // PVS: janela nula; o nó PV refaz com janela cheia quando o lance entra na janela
+            score = -negamax<NODE_NON_PV>(th, board, depth - 1, ply + 1, -alpha - 1, -alpha);
+            if (PV_NODE && score > alpha && score < beta) score = -negamax<NODE_PV>(th, board, depth - 1, ply + 1, -beta, -alpha);
+        }
         board.unmake_move();
         
         if (stop_search) return 0;
@@ -250,19 +772,26 @@ int ChessEngine::negamax(ChessBoard& board, int depth, int ply, int alpha, int b
 
         if (score > alpha) {
             alpha = score;
-            flag = TT_EXACT;
+            // Com janela nula, superar alpha já é um corte
+            if (PV_NODE && score < beta) {
+                flag = TT_EXACT;
+                update_pv(th, ply, move);
+            }
         }
 
         if (alpha >= beta) { 
+            th.stats.beta_cutoffs++;
+            if (moves_searched == 1) th.stats.first_move_cutoffs++;
             if (!is_capture) {
-                if (ply < 20 && !(move == killer_moves[ply][0])) {
-                    killer_moves[ply][1] = killer_moves[ply][0];
-                    killer_moves[ply][0] = move;
+                if (!(move == ss->killers[0])) {
+                    ss->killers[1] = ss->killers[0];
+                    ss->killers[0] = move;
                 }
-                if (move.from < 64 && move.to < 64) {
-                    non_const_this->history_moves[move.from][move.to] += depth * depth;
-                    if (history_moves[move.from][move.to] > 20000) non_const_this->history_moves[move.from][move.to] /= 2;
+                if ((ss - 1)->moved_piece >= 0) {
+                    th.counter_moves[(ss - 1)->moved_piece][(ss - 1)->current_move.to] = move;
                 }
+                int bonus = std::min(16 * depth * depth, 1600);
+                update_quiet_history(th, ss, side, move, piece, bonus);
             }
             flag = TT_BETA;
             break; 
@@ -270,52 +799,301 @@ int ChessEngine::negamax(ChessBoard& board, int depth, int ply, int alpha, int b
     }
     
     if (!stop_search) {
-        tt.store(board.get_hash(), depth, best_val, flag, best_move_this_node);
+        tt->store(board.get_hash(), depth, best_val, flag, best_move_this_node);
     }
     
     return best_val;
 }
 
+// Raiz: percorre th.root_moves na ordem da iteração anterior, a partir de th.pv_index.
+// Sempre com janela cheia; o primeiro lance é PV, os demais PVS.
+template <>
+int ChessEngine::negamax<NODE_ROOT>(SearchThread& th, ChessBoard& board, int depth, int ply, int alpha, int beta) {
+    if (stop_search) return 0;
+    if (++th.stats.nodes >= th.next_check) {
+        check_time(th);
+        if (stop_search) return 0;
+    }
+    th.pv_length[ply] = ply;
+    if (ply + 1 > th.stats.seldepth) th.stats.seldepth = ply + 1;
+
+    SearchStackEntry* ss = th.stack_at(ply);
+    Color side = board.get_side_to_move();
+    int best_val = -INFINITY_SCORE;
+    Move best_move_this_node;
+
+    for (size_t i = th.pv_index; i < th.root_moves.size(); i++) {
+        RootMove& root_move = th.root_moves[i];
+        const Move move = root_move.move;
+        int piece = side * 6 + board.get_piece(move.from);
+        ss->current_move = move;
+        ss->moved_piece = piece;
+        ss->cont_history = &th.continuation_history[piece * 64 + move.to];
+
+        make_search_move(th, board, move, ply);
+        int score;
+        if (i == th.pv_index) {
+            score = -negamax<NODE_PV>(th, board, depth - 1, ply + 1, -beta, -alpha);
+        } else {
+            score = -negamax<NODE_NON_PV>(th, board, depth - 1, ply + 1, -alpha - 1, -alpha);
+            if (score > alpha) score = -negamax<NODE_PV>(th, board, depth - 1, ply + 1, -beta, -alpha);
+        }
+        board.unmake_move();
+
+        if (stop_search) return 0;
+
+        // Lances que não superaram alpha não têm score exato; -infinito mantém
+        // a ordem relativa deles no stable_sort
+        if (score > alpha) {
+            alpha = score;
+            root_move.score = score;
+            update_pv(th, ply, move);
+            root_move.pv.assign(th.pv_table[ply] + ply, th.pv_table[ply] + th.pv_length[ply]);
+        } else {
+            root_move.score = -INFINITY_SCORE;
+        }
+
+        if (score > best_val) {
+            best_val = score;
+            best_move_this_node = move;
+        }
+    }
+
+    // Slots MultiPV > 1 não representam a raiz inteira: não vão para a TT
+    if (!stop_search && th.pv_index == 0) {
+        tt->store(board.get_hash(), depth, best_val, TT_EXACT, best_move_this_node);
+    }
+
+    return best_val;
+}
+
 Move ChessEngine::get_best_move(const ChessBoard& board) {
+    SearchLimits limits;
+    limits.movetime = TIME_LIMIT_MS;
+    limits.move_overhead = 0;
+    return get_best_move(board, limits);
+}
+
+Move ChessEngine::get_best_move(const ChessBoard& board, const SearchLimits& limits) {
+    if (!tt) tt = TTPool::instance().acquire(hash_mb);
+    if (!main_thread) main_thread.reset(new SearchThread(eval_cache_mb));
+    SearchThread& th = *main_thread;
+
+    stop_search = false;
+    stop_received = false;
+    ponder_hit = false;
+    th.pondering = limits.ponder;
+    searching = true;
+
+    Move best = search_root(th, board, limits);
+
+    // Pela UCI o bestmove de um ponder só sai depois de ponderhit ou stop, e o
+    // de um "go infinite" (sem depth/nodes) só depois de stop, mesmo que a
+    // busca (ou o livro) já tenha terminado
+    bool analysis = limits.infinite && limits.depth == 0 && limits.nodes == 0;
+    while (((th.pondering && !ponder_hit) || analysis) && !stop_received) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    th.pondering = false;
+    searching = false;
+    return best;
+}
+
+Move ChessEngine::search_root(SearchThread& th, const ChessBoard& board, const SearchLimits& limits) {
     // [CORREÇÃO] Criar uma cópia mutável do tabuleiro
     ChessBoard search_board = board;
 
     std::vector<Move> legal_moves = search_board.generate_legal_moves();
-    if (legal_moves.empty()) return Move();
+    if (legal_moves.empty()) {
+        th.stats = SearchStats(); // Mate/afogamento: nada da busca anterior
+        return Move();
+    }
 
-    std::memset(history_moves, 0, sizeof(history_moves));
-    for(int i=0; i<20; i++) { killer_moves[i][0] = Move(); killer_moves[i][1] = Move(); }
+    // Lance de livro: resposta imediata
+    Move book_move;
+    if (book && !limits.infinite && book->probe(search_board, book_move, book_best_move, rng)) {
+        th.stats = SearchStats();
+        th.stats.pv.push_back(book_move);
+        if (!silent) std::cout << "info string book move " + book_move.to_string() + "\n" << std::flush;
+        return book_move;
+    }
+
+    // Tablebase na raiz: lance pelo DTZ, também sem busca
+    th.tb_cardinality = std::min(tb_probe_limit, SyzygyTablebases::largest());
+    Move tb_move; SyzygyWDL tb_wdl;
+    if (!limits.infinite && th.tb_cardinality > 0 && count_bits(search_board.all_pieces) <= th.tb_cardinality &&
+        SyzygyTablebases::probe_root(search_board, tb_move, tb_wdl)) {
+        th.stats = SearchStats();
+        th.stats.tbhits = 1;
+        th.stats.pv.push_back(tb_move);
+        last_eval_score = (tb_wdl == TB_WDL_WIN) ? TB_WIN_SCORE : (tb_wdl == TB_WDL_LOSS) ? -TB_WIN_SCORE : 0;
+        if (!silent) std::cout << "info string tablebase move " + tb_move.to_string() + " wdl " + std::to_string((int)tb_wdl) + "\n" << std::flush;
+        return tb_move;
+    }
+
+    th.age_history();
+    th.reset_search_stack();
     
-    start_time = std::chrono::steady_clock::now();
-    stop_search = false;
+    if (network) network->refresh(search_board, th.nnue_stack[0]);
+    th.time_manager.init(limits, search_board.get_side_to_move());
+    th.node_limit = limits.nodes;
+    th.stats = SearchStats();
+    th.next_check = th.node_limit ? std::min(TIME_CHECK_NODES, th.node_limit) : TIME_CHECK_NODES;
+    th.eval_cache.probes = th.eval_cache.hits = 0;
+    th.pawn_table.probes = th.pawn_table.hits = 0;
     
-    Move best_move_global = legal_moves[0];
+    // Ordem inicial da raiz pela ordenação normal (lance da TT, capturas, históricos)
+    TTData tt_data; Move tt_move;
+    if (tt->probe(search_board.get_hash(), tt_data)) tt_move = tt_data.best_move;
+    MovePicker picker(legal_moves);
+    score_moves(th, search_board, picker, legal_moves, 0, tt_move);
+    th.root_moves.clear();
+    for (Move move; picker.next(move);) th.root_moves.push_back({ move, -INFINITY_SCORE, {} });
+    auto by_score = [](const RootMove& a, const RootMove& b) { return a.score > b.score; };
+
+    Move best_move_global = th.root_moves[0].move;
+    int max_depth = (limits.depth > 0) ? std::min(limits.depth, 20) : 20;
+    size_t pv_slots = std::min<size_t>(multi_pv, th.root_moves.size());
+
+    // Lazy SMP: os helpers recebem cópias da raiz e da ordenação inicial
+    std::vector<std::thread> helper_threads;
+    while (helpers.size() + 1 < (size_t)thread_count) helpers.emplace_back(new SearchThread(eval_cache_mb));
+    for (size_t i = 0; i < helpers.size(); i++) {
+        SearchThread& helper = *helpers[i];
+        helper.published_nodes = 0;
+        helper.tb_cardinality = th.tb_cardinality;
+        helper_threads.emplace_back([this, &helper, root = search_board, moves = th.root_moves, max_depth, id = (int)i + 1] {
+            helper_search(helper, root, moves, max_depth, id);
+        });
+    }
     
-    for (int depth = 1; depth <= 20; depth++) {
-        int alpha = -INFINITY_SCORE;
-        int beta = INFINITY_SCORE;
-        
-        // Passa a cópia mutável para o negamax
-        int score = negamax(search_board, depth, 0, alpha, beta);
+    for (int depth = 1; depth <= max_depth; depth++) {
+        th.root_depth = depth;
+
+        // Um slot por vez: o melhor lance do slot sobe para th.pv_index e os demais
+        // mantêm a ordem da iteração anterior. TT e históricos são compartilhados.
+        for (th.pv_index = 0; th.pv_index < pv_slots; th.pv_index++) {
+            negamax<NODE_ROOT>(th, search_board, depth, 0, -INFINITY_SCORE, INFINITY_SCORE);
+            if (stop_search) break;
+            std::stable_sort(th.root_moves.begin() + th.pv_index, th.root_moves.end(), by_score);
+        }
+        th.pv_index = 0;
 
         if (stop_search) break; 
 
-        Move tt_move; int s;
-        // Usa o hash da cópia (que é igual ao original pois negamax restaura o estado)
-        if (tt.probe(search_board.get_hash(), depth, -INFINITY_SCORE, INFINITY_SCORE, s, tt_move)) {
-            best_move_global = tt_move;
+        // Slots buscados com janela cheia, mas um slot posterior pode superar um anterior
+        std::stable_sort(th.root_moves.begin(), th.root_moves.begin() + pv_slots, by_score);
+        std::vector<PVLine> lines(pv_slots);
+        for (size_t i = 0; i < pv_slots; i++) {
+            lines[i].score = th.root_moves[i].score;
+            lines[i].pv = th.root_moves[i].pv;
         }
+
+        best_move_global = lines[0].pv[0];
+        int score = lines[0].score;
         
         // [ATUALIZAÇÃO] Salva o score para a GUI
         last_eval_score = score;
 
-        std::cout << "info depth " << depth << " score cp " << score << " pv " << best_move_global.to_string() << std::endl;
-        if (std::abs(score) > MATE_SCORE - 100) break;
+        th.stats.depth = depth;
+        th.stats.score = score;
+        th.stats.pv = lines[0].pv;
+        th.stats.multipv = lines;
+        th.stats.time_ms = th.time_manager.elapsed_ms();
+        th.stats.nps = th.stats.nodes * 1000 / std::max<int64_t>(1, th.stats.time_ms);
+        th.stats.hashfull = tt->hashfull();
+        // Com helpers, nós e nps informados somam todas as threads
+        const SearchStats* report = &th.stats;
+        SearchStats combined;
+        if (!helper_threads.empty()) {
+            combined = th.stats;
+            combined.nodes += helper_nodes();
+            combined.nps = combined.nodes * 1000 / std::max<int64_t>(1, combined.time_ms);
+            report = &combined;
+        }
+        print_info(*report, lines);
+        if (on_iteration) on_iteration(*report);
+
+        // Enquanto pondera não há relógio: só para com ponderhit + tempo, ou stop
+        check_ponderhit(th);
+        bool time_up = th.time_manager.should_stop_iterating(best_move_global);
+        if (th.pondering) continue;
+        if (std::abs(score) > MATE_SCORE - 100 && !limits.infinite) break;
+        if (time_up) break;
+    }
+
+    // A principal terminou: encerra os helpers (stop_received não muda, o ponder continua esperando)
+    // Contadores finais (incluem a iteração interrompida, se houver)
+    th.stats.eval_cache_probes = th.eval_cache.probes;
+    th.stats.eval_cache_hits = th.eval_cache.hits;
+    th.stats.pawn_probes = th.pawn_table.probes;
+    th.stats.pawn_hits = th.pawn_table.hits;
+    if (!helper_threads.empty()) {
+        stop_search = true;
+        for (auto& helper_thread : helper_threads) helper_thread.join();
+        // Somam todas as threads, como os nós informados a cada iteração
+        for (const auto& helper : helpers) {
+            const SearchStats& hs = helper->stats;
+            th.stats.nodes += hs.nodes;
+            th.stats.qnodes += hs.qnodes;
+            th.stats.tt_probes += hs.tt_probes;
+            th.stats.tt_hits += hs.tt_hits;
+            th.stats.beta_cutoffs += hs.beta_cutoffs;
+            th.stats.first_move_cutoffs += hs.first_move_cutoffs;
+            th.stats.tbhits += hs.tbhits;
+            th.stats.eval_cache_probes += helper->eval_cache.probes;
+            th.stats.eval_cache_hits += helper->eval_cache.hits;
+            th.stats.pawn_probes += helper->pawn_table.probes;
+            th.stats.pawn_hits += helper->pawn_table.hits;
+        }
     }
+    th.stats.time_ms = th.time_manager.elapsed_ms();
+    th.stats.nps = th.stats.nodes * 1000 / std::max<int64_t>(1, th.stats.time_ms);
+
+    if (silent) return best_move_global;
+    auto percent = [](uint64_t part, uint64_t total) { return total ? part * 100 / total : 0; };
+    std::ostringstream out;
+    out << "info string qnodes " << th.stats.qnodes
+        << " tthits " << percent(th.stats.tt_hits, th.stats.tt_probes) << "%"
+        << " evalcache " << percent(th.stats.eval_cache_hits, th.stats.eval_cache_probes) << "%"
+        << " pawnhash " << percent(th.stats.pawn_hits, th.stats.pawn_probes) << "%"
+        << " firstcut " << percent(th.stats.first_move_cutoffs, th.stats.beta_cutoffs) << "%\n";
+    std::cout << out.str() << std::flush;
     
     return best_move_global;
 }
 
+void ChessEngine::helper_search(SearchThread& th, const ChessBoard& board, const std::vector<RootMove>& root_moves, int max_depth, int id) {
+    ChessBoard search_board = board;
+    th.age_history();
+    th.reset_search_stack();
+    if (network) network->refresh(search_board, th.nnue_stack[0]);
+
+    // Sem relógio nem limite de nós: quem para os helpers é a thread principal
+    SearchLimits unlimited;
+    unlimited.infinite = true;
+    th.time_manager.init(unlimited, search_board.get_side_to_move());
+    th.node_limit = 0;
+    th.pondering = false;
+    th.stats = SearchStats();
+    th.eval_cache.probes = th.eval_cache.hits = 0;
+    th.pawn_table.probes = th.pawn_table.hits = 0;
+    th.next_check = TIME_CHECK_NODES;
+    th.root_moves = root_moves;
+    th.pv_index = 0;
+    auto by_score = [](const RootMove& a, const RootMove& b) { return a.score > b.score; };
+
+    // Helpers ímpares começam uma iteração à frente: profundidades diferentes
+    // espalham o trabalho pela TT em vez de repetir a busca da principal
+    for (int depth = 1 + (id & 1); depth <= max_depth && !stop_search; depth++) {
+        th.root_depth = depth;
+        negamax<NODE_ROOT>(th, search_board, depth, 0, -INFINITY_SCORE, INFINITY_SCORE);
+        if (stop_search) break;
+        std::stable_sort(th.root_moves.begin(), th.root_moves.end(), by_score);
+    }
+    th.published_nodes.store(th.stats.nodes, std::memory_order_relaxed);
+}
+
 Move ChessEngine::get_random_move(const ChessBoard& board) {
     std::vector<Move> moves = board.generate_legal_moves();
     if (moves.empty()) return Move();
@@ -2,9 +2,22 @@
 #define CHESS_ENGINE_H
 
 #include "chess.h"
+#include "nnue.h"
+#include "polyglot.h"
+#include "syzygy.h"
 #include <vector>
+#include <array>
 #include <random>
 #include <chrono>
+#include <cstdint>
+#include <utility>
+#include <memory>
+#include <string>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
 
 // Tipos de flags para a Transposition Table
 enum TTFlag {
@@ -13,101 +26,558 @@ enum TTFlag {
     TT_BETA   // Lower Bound
 };
 
-// Entrada da Tabela
-struct TTEntry {
-    uint64_t key;
+// Conteúdo de uma entrada, já decodificado
+struct TTData {
     int score;
     int depth;
     TTFlag flag;
-    Move best_move;
+    Move best_move; // Só origem, destino e promoção: a busca compara com lances gerados
+
+    // O score resolve o nó com esta janela e profundidade?
+    bool cutoff(int min_depth, int alpha, int beta, int& out) const {
+        if (depth < min_depth) return false;
+        if (flag == TT_EXACT) { out = score; return true; }
+        if (flag == TT_ALPHA && score <= alpha) { out = alpha; return true; }
+        if (flag == TT_BETA && score >= beta) { out = beta; return true; }
+        return false;
+    }
+};
+
+// Entrada da Tabela: dois words atômicos, a chave guardada como key ^ data.
+// Várias buscas podem ler e escrever a mesma tabela sem lock: uma escrita
+// concorrente que misture metades de entradas diferentes faz a chave não
+// conferir, e a entrada é tratada como ausente.
+struct TTEntry {
+    std::atomic<uint64_t> key_xor_data;
+    std::atomic<uint64_t> data; // score 32 | depth 8 | flag 2 | from 7 | to 7 | promoção 3
 };
 
-// Classe da Tabela de Transposição
+// Classe da Tabela de Transposição. Pode ser compartilhada entre engines
+// (ver TTPool); contadores de probes/hits ficam nas estatísticas de cada busca.
 class TranspositionTable {
 private:
-    std::vector<TTEntry> table;
+    std::unique_ptr<TTEntry[]> table;
     size_t size;
+    size_t megabytes;
+
+    static uint64_t pack(int depth, int score, TTFlag flag, const Move& move) {
+        return (uint64_t)(uint32_t)score
+             | (uint64_t)(uint8_t)std::min(depth, 255) << 32
+             | (uint64_t)flag << 40
+             | (uint64_t)(move.from & 0x7F) << 42
+             | (uint64_t)(move.to & 0x7F) << 49
+             | (uint64_t)(move.promotion & 0x7) << 56;
+    }
+
+    static TTData unpack(uint64_t data) {
+        TTData out;
+        out.score = (int32_t)(uint32_t)data;
+        out.depth = (int)((data >> 32) & 0xFF);
+        out.flag = (TTFlag)((data >> 40) & 0x3);
+        out.best_move = Move((Square)((data >> 42) & 0x7F), (Square)((data >> 49) & 0x7F), (PieceType)((data >> 56) & 0x7));
+        return out;
+    }
 
 public:
-    TranspositionTable(size_t size_mb = 64) {
-        // Tamanho de cada entrada = 24 bytes aprox.
-        // 64MB dá cerca de 2.6 milhões de entradas
-        size = (size_mb * 1024 * 1024) / sizeof(TTEntry);
-        table.resize(size);
+    // Tamanho de cada entrada = 16 bytes; 64MB dá cerca de 4.2 milhões de entradas
+    explicit TranspositionTable(size_t size_mb = 64) : megabytes(size_mb) {
+        size = std::max<size_t>(1, (size_mb * 1024 * 1024) / sizeof(TTEntry));
+        table.reset(new TTEntry[size]);
+        clear();
     }
 
+    TranspositionTable(const TranspositionTable&) = delete;
+    TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+    size_t size_mb() const { return megabytes; }
+
     void clear() {
-        std::fill(table.begin(), table.end(), TTEntry{0, 0, 0, TT_EXACT, Move()});
+        for (size_t i = 0; i < size; i++) {
+            table[i].key_xor_data.store(0, std::memory_order_relaxed);
+            table[i].data.store(0, std::memory_order_relaxed);
+        }
     }
 
     // Armazenar
     void store(uint64_t key, int depth, int score, TTFlag flag, Move best_move) {
-        size_t index = key % size;
+        TTEntry& entry = table[key % size];
+        uint64_t old_data = entry.data.load(std::memory_order_relaxed);
+        uint64_t old_key = entry.key_xor_data.load(std::memory_order_relaxed) ^ old_data;
         // Substituição simples: profundidade maior ou igual substitui
-        if (table[index].key == 0 || depth >= table[index].depth) {
-            table[index] = {key, score, depth, flag, best_move};
+        if (old_key == 0 || depth >= (int)((old_data >> 32) & 0xFF)) {
+            uint64_t data = pack(depth, score, flag, best_move);
+            entry.key_xor_data.store(key ^ data, std::memory_order_relaxed);
+            entry.data.store(data, std::memory_order_relaxed);
         }
     }
 
-    // Recuperar
-    bool probe(uint64_t key, int depth, int alpha, int beta, int& score, Move& best_move) {
-        size_t index = key % size;
-        const TTEntry& entry = table[index];
-
-        if (entry.key == key) {
-            best_move = entry.best_move; // Sempre útil para ordenação
-            if (entry.depth >= depth) {
-                if (entry.flag == TT_EXACT) {
-                    score = entry.score;
-                    return true;
-                }
-                if (entry.flag == TT_ALPHA && entry.score <= alpha) {
-                    score = alpha;
-                    return true;
-                }
-                if (entry.flag == TT_BETA && entry.score >= beta) {
-                    score = beta;
-                    return true;
-                }
-            }
+    // Recuperar: true se a chave confere
+    bool probe(uint64_t key, TTData& out) const {
+        const TTEntry& entry = table[key % size];
+        uint64_t data = entry.data.load(std::memory_order_relaxed);
+        if ((entry.key_xor_data.load(std::memory_order_relaxed) ^ data) != key) return false;
+        out = unpack(data);
+        return true;
+    }
+
+    // Ocupação em permil, estimada pelas primeiras 1000 entradas (UCI "hashfull")
+    int hashfull() const {
+        size_t sample = std::min<size_t>(1000, size);
+        int used = 0;
+        for (size_t i = 0; i < sample; i++) {
+            if (table[i].key_xor_data.load(std::memory_order_relaxed) != table[i].data.load(std::memory_order_relaxed)) used++;
+        }
+        return (int)(used * 1000 / sample);
+    }
+};
+
+// Orçamento global (MB) das TTs do processo. Cada engine pede a tabela ao
+// pool: uma exclusiva, limitada ao que resta do orçamento, ou a tabela
+// compartilhada, para processos com centenas de partidas simultâneas.
+// A memória volta ao orçamento quando a última engine solta a tabela.
+class TTPool {
+private:
+    std::mutex mutex;
+    size_t budget = 0; // 0 = sem limite
+    size_t used = 0;
+    std::weak_ptr<TranspositionTable> shared_table;
+    std::vector<std::weak_ptr<TranspositionTable>> tables; // Entregues (para compartilhar sem orçamento)
+    std::condition_variable changed; // Tabela criada ou devolvida
+    bool creating_shared = false;
+
+public:
+    static TTPool& instance();
+
+    void set_budget(size_t size_mb);
+    size_t budget_mb();
+    size_t used_mb();
+
+    // Tabela exclusiva de até size_mb (o que couber no orçamento); com o
+    // orçamento esgotado recebe a tabela compartilhada, sem passar do limite
+    std::shared_ptr<TranspositionTable> acquire(size_t size_mb);
+    // Tabela única do pool, criada (com size_mb) pelo primeiro pedido
+    std::shared_ptr<TranspositionTable> shared(size_t size_mb);
+};
+
+// Entrada da Pawn Hash Table: termos de estrutura de peões (brancas - pretas)
+struct PawnEntry {
+    uint64_t key;
+    int mg;
+    int eg;
+};
+
+// Cache da estrutura de peões. Medido em "info string ... pawnhash": 56-92%
+// de acerto conforme a posição (~63% num "go" a partir da posição inicial).
+// As falhas são estruturas novas (lances de peão na árvore), não colisões.
+class PawnHashTable {
+private:
+    std::vector<PawnEntry> table;
+    size_t mask;
+
+public:
+    uint64_t probes = 0;
+    uint64_t hits = 0;
+
+    PawnHashTable(size_t entries = 1 << 14) : table(entries, PawnEntry{0, 0, 0}), mask(entries - 1) {}
+
+    // Devolve a entrada do slot; o chamador confere a chave
+    PawnEntry& probe(uint64_t key, bool& found) {
+        PawnEntry& entry = table[key & mask];
+        probes++;
+        found = (entry.key == key);
+        if (found) hits++;
+        return entry;
+    }
+};
+
+// Cache de avaliações estáticas, indexado pelo hash Zobrist da posição.
+// Por thread e com perdas: colisões simplesmente sobrescrevem o slot.
+// Cada entrada ocupa 64 bits: 32 bits altos da chave + avaliação.
+class EvalCache {
+private:
+    std::vector<uint64_t> table;
+    size_t mask;
+
+public:
+    uint64_t probes = 0;
+    uint64_t hits = 0;
+
+    EvalCache(size_t size_mb = 4) { resize(size_mb); }
+
+    void resize(size_t size_mb) {
+        size_t entries = 1;
+        while (entries * 2 * sizeof(uint64_t) <= size_mb * 1024 * 1024) entries *= 2;
+        table.assign(entries, 0);
+        mask = entries - 1;
+    }
+
+    void clear() { std::fill(table.begin(), table.end(), 0); }
+
+    bool probe(uint64_t key, int& eval) {
+        probes++;
+        uint64_t entry = table[key & mask];
+        if (entry != 0 && (uint32_t)(entry >> 32) == (uint32_t)(key >> 32)) {
+            eval = (int32_t)(uint32_t)entry;
+            hits++;
+            return true;
         }
         return false;
     }
+
+    void store(uint64_t key, int eval) {
+        table[key & mask] = (key & 0xFFFFFFFF00000000ULL) | (uint32_t)eval;
+    }
 };
 
+// Limites de busca (espelham os parâmetros do comando "go" da UCI)
+// Tempos em milissegundos; valores negativos significam "não informado".
+struct SearchLimits {
+    int wtime = -1;
+    int btime = -1;
+    int winc = 0;
+    int binc = 0;
+    int movestogo = 0;
+    int movetime = -1;
+    int depth = 0;          // 0 = sem limite de profundidade
+    uint64_t nodes = 0;     // 0 = sem limite de nós
+    bool infinite = false;
+    bool ponder = false;    // "go ponder": busca sem relógio até ponderhit/stop
+    int move_overhead = 30; // Margem para latência de comunicação
+};
+
+// Linha de um slot MultiPV: lance da raiz + continuação
+struct PVLine {
+    int score = 0;
+    std::vector<Move> pv;
+};
+
+// Estatísticas da última busca (zeradas a cada get_best_move)
+struct SearchStats {
+    int depth = 0;                   // Última iteração completa
+    int seldepth = 0;                // Maior ply alcançado (incl. quiescência)
+    int score = 0;
+    int64_t time_ms = 0;
+    uint64_t nodes = 0;              // Todos os nós (negamax + quiescência)
+    uint64_t qnodes = 0;             // Apenas quiescência
+    uint64_t nps = 0;
+    uint64_t tt_probes = 0;
+    uint64_t tt_hits = 0;
+    int hashfull = 0;                // Permil
+    uint64_t beta_cutoffs = 0;
+    uint64_t first_move_cutoffs = 0; // Cortes no primeiro lance buscado (qualidade da ordenação)
+    uint64_t eval_cache_probes = 0;
+    uint64_t eval_cache_hits = 0;
+    uint64_t pawn_probes = 0;
+    uint64_t pawn_hits = 0;
+    uint64_t tbhits = 0;             // Consultas bem-sucedidas às tablebases
+    std::vector<Move> pv;            // Variante principal da última iteração
+    std::vector<PVLine> multipv;     // Slots MultiPV da última iteração completa (multipv[0] = pv)
+};
+
+// Gerenciador de tempo: converte os limites em um orçamento soft (não
+// iniciar nova iteração) e hard (abortar a busca em andamento).
+class TimeManager {
+private:
+    std::chrono::steady_clock::time_point start;
+    int64_t soft_ms;
+    int64_t hard_ms;
+    bool limited;
+    bool fixed_time; // "go movetime": usa o orçamento inteiro
+
+    // Estabilidade do melhor lance entre iterações
+    Move last_best;
+    int stability;
+
+public:
+    TimeManager() : soft_ms(0), hard_ms(0), limited(false), fixed_time(false), stability(0) {}
+
+    void init(const SearchLimits& limits, Color side);
+    // Reinicia o relógio mantendo o orçamento (ponderhit: nosso tempo começa agora)
+    void restart() { start = std::chrono::steady_clock::now(); }
+    int64_t elapsed_ms() const;
+    bool hard_limit_reached() const { return limited && elapsed_ms() >= hard_ms; }
+    // Chamado ao fim de cada iteração; usa a estabilidade do melhor lance
+    // para encerrar mais cedo em posições fáceis.
+    bool should_stop_iterating(const Move& best_move);
+};
+
+// Profundidade máxima (em plies) que a busca pode atingir
+const int MAX_PLY = 128;
+
+// Teto dos valores de histórico (atualização com "gravidade")
+const int HISTORY_MAX = 16384;
+
+// Histórico [peça][destino], onde peça = cor * 6 + tipo
+using PieceToHistory = std::array<std::array<int16_t, 64>, 12>;
+
+// Entrada da pilha de busca (uma por ply)
+struct SearchStackEntry {
+    Move current_move;
+    int moved_piece;              // cor * 6 + tipo; -1 se não houve lance
+    int static_eval;
+    Move killers[2];
+    PieceToHistory* cont_history; // Tabela de continuação do lance deste ply
+};
+
+// Tipo de nó da busca (parâmetro de template do negamax). Raiz e nós PV têm
+// janela aberta e mantêm a PV; com PVS, quase todos os nós são NON_PV
+// (janela nula), sem essa contabilidade e com cortes da TT e podas liberados.
+enum NodeType {
+    NODE_ROOT,
+    NODE_PV,
+    NODE_NON_PV
+};
+
+// Lance da raiz com o resultado da iteração atual: a lista é reordenada
+// (stable_sort) após cada busca e define a ordem da iteração seguinte
+struct RootMove {
+    Move move;
+    int score;          // Exato para o melhor de cada slot; -infinito se não superou alpha
+    std::vector<Move> pv;
+};
+
+// Limite de lances por posição (o máximo legal conhecido é 218)
+const int MAX_MOVES = 256;
+
+// Seletor incremental de lances: cada lance é pontuado uma única vez em um
+// array paralelo e o próximo melhor é escolhido sob demanda (seleção
+// parcial), já que a maioria dos nós corta após um ou dois lances.
+class MovePicker {
+private:
+    std::vector<Move>& moves;
+    int scores[MAX_MOVES];
+    size_t current;
+
+public:
+    explicit MovePicker(std::vector<Move>& moves) : moves(moves), current(0) {}
+
+    int* score_table() { return scores; }
+
+    // Devolve o próximo lance de maior pontuação; false quando acabarem
+    bool next(Move& move, int* score = nullptr) {
+        if (current >= moves.size()) return false;
+        size_t best = current;
+        for (size_t i = current + 1; i < moves.size(); i++) {
+            if (scores[i] > scores[best]) best = i;
+        }
+        std::swap(moves[current], moves[best]);
+        std::swap(scores[current], scores[best]);
+        move = moves[current];
+        if (score) *score = scores[current];
+        current++;
+        return true;
+    }
+};
+
+// Contagens de termos da avaliação manual para uma cor
+struct PawnTerms {
+    int passed[8] = {}; // Por rank relativo
+    int isolated = 0;
+    int doubled = 0;
+    int backward = 0;
+};
+
+struct ShieldTerms {
+    int shield_near = 0;
+    int shield_far = 0;
+    int shield_missing = 0;
+};
+
+// Avaliação manual decomposta em termos lineares (brancas - pretas), usada
+// pelo texel_tuner: avaliação = soma de contagem x peso, interpolada pela fase.
+struct EvalTrace {
+    int phase = 0;          // min(fase do jogo, MAX_PHASE)
+    int material[6] = {};
+    int pst[6][64] = {};    // Layout PeSTO (índice 0 = a8)
+    int mobility[6] = {};   // Sem interpolação
+    PawnTerms pawns;
+    ShieldTerms shield;     // Apenas meio-jogo
+};
+
+// Estado de busca de uma thread: tudo que a busca escreve fica aqui, e não na
+// ChessEngine. Heurísticas de ordenação são envelhecidas entre lances, não zeradas.
+struct SearchThread {
+    int history_moves[2][64][64];           // [cor][origem][destino]
+    Move counter_moves[12][64];             // Resposta ao lance anterior [peça][destino]
+    std::vector<PieceToHistory> continuation_history; // [peça][destino] -> [peça][destino]
+    SearchStackEntry search_stack[MAX_PLY + 4];
+
+    // Variante principal (tabela triangular): pv_table[ply] é a linha a partir de ply
+    Move pv_table[MAX_PLY][MAX_PLY];
+    int pv_length[MAX_PLY];
+    int root_depth = 0;
+
+    // MultiPV: o slot pv_index busca root_moves[pv_index..]; os anteriores já
+    // são as melhores linhas desta iteração
+    std::vector<RootMove> root_moves;
+    size_t pv_index = 0;
+
+    bool pondering = false;  // Busca atual ainda é ponder (sem limite de tempo)
+    TimeManager time_manager;
+    uint64_t node_limit = 0; // "go nodes" da busca atual (0 = sem limite)
+    uint64_t next_check = 0; // stats.nodes da próxima chamada de check_time
+    int tb_cardinality = 0;  // min(limite, maior tabela) da busca atual; 0 = desligado
+    SearchStats stats;
+    std::atomic<uint64_t> published_nodes{ 0 }; // stats.nodes visível às outras threads (a cada check_time)
+
+    PawnHashTable pawn_table;
+    EvalCache eval_cache;
+    std::vector<NNUEAccumulator> nnue_stack; // Um acumulador por ply
+
+    explicit SearchThread(size_t eval_cache_mb) : eval_cache(eval_cache_mb), nnue_stack(MAX_PLY + 8) {
+        clear_history();
+        pv_length[0] = 0;
+    }
+
+    SearchStackEntry* stack_at(int ply) { return &search_stack[ply + 2]; } // 2 sentinelas antes da raiz
+    void reset_search_stack();
+    void clear_history();
+    void age_history();
+};
+
+// Padrão da opção UCI EvalFile (a engine em si não carrega nada sozinha)
+const char* const DEFAULT_NETWORK_FILE = "network.nnue";
+// Livro da GUI; na UCI só com a opção BookFile
+const char* const DEFAULT_BOOK_FILE = "book.bin";
+
 class ChessEngine {
 private:
     std::mt19937 rng;
 
-    mutable int history_moves[64][64];
-    mutable Move killer_moves[20][2];
-    mutable bool stop_search;
-    mutable std::chrono::time_point<std::chrono::steady_clock> start_time;
-    
-    // [NOVO] Instância da TT
-    mutable TranspositionTable tt;
+    std::atomic<bool> stop_search; // Escrito por outra thread (stop/ponderhit da UCI ou da GUI)
+    std::atomic<bool> stop_received; // Só o "stop" externo: stop_search também encerra os helpers
+    std::atomic<bool> ponder_hit;
+    std::atomic<bool> searching;
+    bool silent; // Suprime as linhas "info" (bench, ferramentas em lote)
+    int multi_pv;
+    std::function<void(const SearchStats&)> on_iteration;
+
+    // TT vinda do TTPool, exclusiva ou compartilhada com outras engines;
+    // alocada na primeira busca (engines que só avaliam não pagam por ela)
+    std::shared_ptr<TranspositionTable> tt;
+    size_t hash_mb;
+    // Estado da busca, criado na primeira busca
+    std::unique_ptr<SearchThread> main_thread;
+    size_t eval_cache_mb;
+    // Lazy SMP: threads auxiliares buscam a mesma raiz e só contribuem pela TT
+    std::vector<std::unique_ptr<SearchThread>> helpers;
+    int thread_count;
+
+    // Avaliação NNUE opcional (nullptr -> avaliação manual)
+    std::shared_ptr<NNUENetwork> network;
+
+    // Livro de aberturas opcional (nullptr -> sempre busca)
+    std::shared_ptr<PolyglotBook> book;
+    bool book_best_move; // Maior peso em vez de sorteio ponderado
+
+    // Tablebases Syzygy (globais ao processo, ver SyzygyTablebases)
+    int tb_probe_limit;         // Máximo de peças para consultar
+    int tb_probe_depth;         // Profundidade mínima restante para consultar na busca
 
     static const int PIECE_VALUES[7];
 
-    int evaluate_material(const ChessBoard& board) const;
-    void order_moves(const ChessBoard& board, std::vector<Move>& moves, int ply, const Move& tt_move) const;
-    void order_moves_simple(const ChessBoard& board, std::vector<Move>& moves) const;
-    int quiescence(ChessBoard& board, int alpha, int beta, int depth_left) const;
-    int negamax(ChessBoard& board, int depth, int ply, int alpha, int beta) const;
+    // pawn_cache opcional (nullptr -> calcula a estrutura de peões sempre)
+    int evaluate_material(const ChessBoard& board, PawnHashTable* pawn_cache) const;
+    void score_moves(SearchThread& th, const ChessBoard& board, MovePicker& picker, const std::vector<Move>& moves, int ply, const Move& tt_move) const;
+    void score_captures(const ChessBoard& board, MovePicker& picker, const std::vector<Move>& moves) const;
+    int quiescence(SearchThread& th, ChessBoard& board, int alpha, int beta, int depth_left, int ply);
+    // Static Exchange Evaluation: a troca iniciada por move ganha ao menos threshold?
+    bool see_ge(const ChessBoard& board, const Move& move, int threshold) const;
+
+    // Avaliação estática do ponto de vista do lado a jogar (NNUE ou manual)
+    int evaluate(SearchThread& th, const ChessBoard& board, int ply) const;
+    // Executa o lance e atualiza o acumulador NNUE do próximo ply
+    void make_search_move(SearchThread& th, ChessBoard& board, const Move& move, int ply) const;
+    // Especializado por tipo de nó; NODE_ROOT tem o próprio laço sobre root_moves
+    template <NodeType NT>
+    int negamax(SearchThread& th, ChessBoard& board, int depth, int ply, int alpha, int beta);
+
+    void eval_pawns(const ChessBoard& board, PawnHashTable* pawn_cache, int& mg, int& eg) const;
+    int eval_pawn_shield(const ChessBoard& board, Color c) const;
+    static void count_pawn_terms(const ChessBoard& board, Color us, PawnTerms& terms);
+    static void count_shield_terms(const ChessBoard& board, Color c, ShieldTerms& terms);
+    static void count_mobility(const ChessBoard& board, Color c, int attacks[6]);
+
+    void update_quiet_history(SearchThread& th, SearchStackEntry* ss, Color side, const Move& move, int piece, int bonus) const;
 
-    int ChessEngine::eval_pawns(const ChessBoard &board) const;
+    // Checa o relógio a cada TIME_CHECK_NODES nós (antes, se o limite de nós chegar)
+    void check_time(SearchThread& th);
+    // Ponderhit recebido: a busca passa a respeitar o relógio a partir de agora
+    void check_ponderhit(SearchThread& th);
+    Move search_root(SearchThread& th, const ChessBoard& board, const SearchLimits& limits);
+    // Aprofundamento iterativo de uma thread auxiliar até stop_search
+    void helper_search(SearchThread& th, const ChessBoard& board, const std::vector<RootMove>& root_moves, int max_depth, int id);
+    uint64_t helper_nodes() const; // Soma aproximada durante a busca
+    void update_pv(SearchThread& th, int ply, const Move& move) const;
+    // Linhas "info ... multipv N" UCI da iteração, numa escrita só
+    void print_info(const SearchStats& stats, const std::vector<PVLine>& lines) const;
 
     
     // [NOVO] Armazenar última avaliação
-    mutable int last_eval_score;
+    int last_eval_score;
 
 public:
     ChessEngine();
     
     Move get_best_move(const ChessBoard& board);
+    Move get_best_move(const ChessBoard& board, const SearchLimits& limits);
+    // Controle a partir de outra thread durante get_best_move
+    void stop() { stop_received = true; stop_search = true; }
+    void ponderhit() { ponder_hit = true; }
+    bool is_searching() const { return searching; }
     int get_last_eval() const { return last_eval_score; } // Getter
+    const SearchStats& get_search_stats() const;
+    void set_silent(bool value) { silent = value; }
+    void set_multi_pv(int lines) { multi_pv = std::max(1, lines); }
+    // Threads de busca sobre a mesma TT (1 = só a principal)
+    void set_threads(int count);
+    int get_threads() const { return thread_count; }
+    // Chamado na thread da busca ao fim de cada iteração completa (resultados parciais)
+    void set_iteration_callback(std::function<void(const SearchStats&)> callback) { on_iteration = std::move(callback); }
+    // Score de mate -> lances até o mate (negativo = levando mate); 0 se não for mate
+    static int mate_in(int score);
+    // Score fora da faixa de mate -> centipawns para exibição (vitória de
+    // tablebase vira +-TB_WIN_CP menos a distância em plies)
+    static int score_to_cp(int score);
+
+    // TT exclusiva de size_mb (limitada pelo orçamento do TTPool); o conteúdo é descartado
+    void set_hash_size(size_t size_mb) { tt.reset(); hash_mb = size_mb; }
+    // Usa uma tabela já existente, p.ex. TTPool::instance().shared(...) ou a de
+    // outra engine; várias engines podem buscar ao mesmo tempo sobre ela
+    void set_transposition_table(std::shared_ptr<TranspositionTable> table) { tt = std::move(table); }
+    // Esquece TT (se exclusiva), caches e históricos (posições não relacionadas, "ucinewgame")
+    void new_game();
+    // Só os históricos: a TT segue valendo (análise de muitas posições em sequência)
+    void clear_history();
+
+    // Avaliação manual (material, PST, peões, mobilidade) do ponto de vista das brancas
+    int static_evaluation(const ChessBoard& board) const { return evaluate_material(board, nullptr); }
+    // Termos da avaliação manual, para ajuste de pesos (texel_tuner)
+    void trace_evaluation(const ChessBoard& board, EvalTrace& trace) const;
+
+    // Carrega uma rede NNUE; em caso de falha mantém a avaliação atual. Nenhuma
+    // rede é carregada por padrão: quem hospeda a engine escolhe (EvalFile, --network)
+    bool load_network(const std::string& path);
+    // Rede já carregada, p.ex. uma só para todas as engines de uma ferramenta
+    void set_network(std::shared_ptr<NNUENetwork> net);
+    bool using_network() const { return network != nullptr; }
+    void unload_network() { set_network(nullptr); }
+
+    // Livro Polyglot: lances do livro são jogados na hora, sem busca
+    // (exceto em "go infinite", que é análise). Nenhum livro por padrão
+    bool load_book(const std::string& path);
+    void unload_book() { book.reset(); }
+    bool using_book() const { return book != nullptr; }
+    void set_book_best_move(bool value) { book_best_move = value; }
+
+    // Limites de consulta às tablebases (SyzygyPath é carregado via SyzygyTablebases::init)
+    void set_syzygy_probe_limit(int pieces) { tb_probe_limit = pieces; }
+    void set_syzygy_probe_depth(int depth) { tb_probe_depth = depth; }
+
+    // Tamanho do cache de avaliações (MB), um por thread de busca
+    void set_eval_cache_size(size_t size_mb);
     Move get_random_move(const ChessBoard& board);
     bool has_legal_moves(const ChessBoard& board) const;
 };
 
-#endif // CHESS_ENGINE_H
\ No newline at end of file
+#endif // CHESS_ENGINE_H
@@ -12,6 +12,8 @@ ChessGUI::ChessGUI()
       // Threads
       is_thinking(false),
       move_ready(false),
+      is_pondering(false),
+      discard_result(false),
       // Estado
       current_state(MENU),
       player_color(WHITE),
@@ -47,10 +49,12 @@ ChessGUI::ChessGUI()
     black_clock_text.setFont(font);
     
     load_piece_textures();
+    engine.load_network(DEFAULT_NETWORK_FILE); // Sem o arquivo, avaliação manual
+    engine.load_book(DEFAULT_BOOK_FILE);
 }
 
 ChessGUI::~ChessGUI() { 
-    if (engine_thread.joinable()) engine_thread.join();
+    stop_engine_search();
     if (window.isOpen()) window.close(); 
 }
 
@@ -91,17 +95,64 @@ void ChessGUI::start_engine_thinking() {
     is_thinking = true;
     move_ready = false;
     if (engine_thread.joinable()) engine_thread.join();
-    engine_thread = std::thread(&ChessGUI::engine_worker, this, board);
+
+    // Repassa os relógios da partida para o gerenciador de tempo da engine
+    SearchLimits limits;
+    limits.wtime = (int)(white_time_seconds * 1000);
+    limits.btime = (int)(black_time_seconds * 1000);
+    engine_thread = std::thread(&ChessGUI::engine_worker, this, board, limits);
 }
 
-void ChessGUI::engine_worker(ChessBoard board_copy) {
-    Move best = engine.get_best_move(board_copy);
+void ChessGUI::engine_worker(ChessBoard board_copy, SearchLimits limits) {
+    Move best = engine.get_best_move(board_copy, limits);
+    if (discard_result) return;
     calculated_move = best;
     current_eval = engine.get_last_eval(); // Atualiza avaliação da GUI
     is_thinking = false;
     move_ready = true;
 }
 
+void ChessGUI::start_engine_pondering(const Move& engine_move) {
+    const std::vector<Move>& pv = engine.get_search_stats().pv;
+    if (pv.size() < 2 || !(pv[0] == engine_move)) return;
+
+    ChessBoard ponder_board = board;
+    if (!ponder_board.make_move(pv[1])) return;
+    if (engine_thread.joinable()) engine_thread.join();
+
+    ponder_move = pv[1];
+    is_pondering = true;
+    SearchLimits limits;
+    limits.wtime = (int)(white_time_seconds * 1000);
+    limits.btime = (int)(black_time_seconds * 1000);
+    limits.ponder = true;
+    engine_thread = std::thread(&ChessGUI::engine_worker, this, ponder_board, limits);
+    // O ponder só termina com ponderhit/stop: espera a busca começar para não perdê-los
+    while (!engine.is_searching()) std::this_thread::yield();
+}
+
+void ChessGUI::resolve_ponder(const Move& played) {
+    if (!is_pondering) return;
+    is_pondering = false;
+    if (played == ponder_move && !game_ended) {
+        // A busca segue com a árvore/TT já construídas, agora contra o relógio
+        is_thinking = true;
+        engine.ponderhit();
+    } else {
+        stop_engine_search();
+    }
+}
+
+void ChessGUI::stop_engine_search() {
+    discard_result = true;
+    engine.stop();
+    if (engine_thread.joinable()) engine_thread.join();
+    discard_result = false;
+    is_pondering = false;
+    is_thinking = false;
+    move_ready = false;
+}
+
 void ChessGUI::apply_engine_move() {
     Move m = calculated_move;
     if (m.from != NO_SQUARE) {
@@ -143,6 +194,7 @@ void ChessGUI::apply_engine_move() {
         }
         update_status_text();
         std::cout << "Engine jogou: " << m.to_string() << "\n";
+        if (!game_ended) start_engine_pondering(m);
     }
 }
 
@@ -274,6 +326,7 @@ void ChessGUI::handle_mouse_click(int x, int y) {
                 } else if (board.is_stalemate(board.get_side_to_move())) {
                     game_ended = true;
                 }
+                resolve_ponder(m);
                 break;
             }
         }
@@ -305,6 +358,7 @@ void ChessGUI::handle_promotion_click(int x, int y) {
     board.make_move(pending_promotion_move);
     last_move = pending_promotion_move; has_last_move = true;
     awaiting_promotion = false;
+    resolve_ponder(pending_promotion_move);
     move_start_time = std::chrono::steady_clock::now();
     update_status_text();
 }
@@ -760,6 +814,7 @@ void ChessGUI::draw_clocks_and_captured() {
 }
 
 void ChessGUI::reset_game() {
+    stop_engine_search(); // Descarta busca ou ponder da partida anterior
     board = ChessBoard();
     game_started = true;
     game_ended = false;
@@ -795,6 +850,7 @@ void ChessGUI::start_game() {
 }
 
 void ChessGUI::resign(Color c) {
+    stop_engine_search();
     game_ended = true;
     winner = (c == WHITE) ? BLACK : WHITE;
 }
@@ -34,6 +34,11 @@ private:
     std::atomic<bool> move_ready;
     Move calculated_move;
 
+    // Ponder: enquanto o jogador pensa, a engine busca a resposta esperada (PV[1])
+    std::atomic<bool> is_pondering;
+    std::atomic<bool> discard_result; // Busca interrompida: não aplicar o lance
+    Move ponder_move;
+
     // Estado
     GameStateGUI current_state;
     Color player_color; 
@@ -151,8 +156,12 @@ private:
     
     // Engine & Jogo
     void start_engine_thinking();
-    void engine_worker(ChessBoard board_copy);
+    void engine_worker(ChessBoard board_copy, SearchLimits limits);
     void apply_engine_move();
+    void start_engine_pondering(const Move& engine_move);
+    // Lance do jogador: ponderhit se foi o previsto, senão descarta o ponder
+    void resolve_ponder(const Move& played);
+    void stop_engine_search();
     
     void update_clocks();
     void update_status_text();
@@ -0,0 +1,338 @@
+// Gerador de dados por self-play (formato binário de training_data.h)
+// Uso:
+//   ./datagen <saida.bin> [--positions N] [--threads N] [--nodes N] [--random-plies N]
+//             [--max-opening-score CP] [--hash MB] [--seed S] [--network ARQ]
+//
+// Cada thread joga partidas da engine contra ela mesma com limite fixo de nós,
+// a partir de alguns lances aleatórios. Posições quietas (sem xeque, lance da
+// busca não é captura/promoção, score não é mate) são guardadas com o score da
+// busca e, no fim da partida, com o resultado. Posições repetidas (mesmo hash
+// Zobrist) são descartadas. Se o arquivo já existir, a geração continua de onde
+// parou (o índice de duplicatas é reconstruído a partir dele).
+
+#include "chess_engine.h"
+#include "training_data.h"
+#include "game_rules.h"
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <filesystem>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+const size_t FLUSH_POSITIONS = 4096;        // Buffer por thread antes de gravar
+const int FLUSH_SECONDS = 30;               // ... ou a cada 30 s
+
+std::atomic<bool> interrupted{ false };
+
+void on_signal(int) { interrupted = true; }
+
+struct GenOptions {
+    std::string output;
+    uint64_t positions = 1000000;
+    int threads = 1;
+    uint64_t nodes = 5000;
+    int random_plies = 8;
+    int max_opening_score = 1000;
+    size_t hash_mb = 16;
+    uint64_t seed = 0;
+    std::string network; // Rede NNUE; vazio = avaliação manual
+};
+
+struct Sample {
+    uint64_t key;
+    PackedPosition packed;
+};
+
+// Conjunto de hashes com endereçamento aberto (0 = vazio): 8 bytes por slot,
+// bem menos que um unordered_set para dezenas de milhões de posições
+class HashSet {
+private:
+    std::vector<uint64_t> slots;
+    size_t used = 0;
+
+public:
+    HashSet() : slots(1 << 16, 0) {}
+
+    size_t size() const { return used; }
+
+    // false se já estava no conjunto
+    bool insert(uint64_t key) {
+        if (key == 0) key = 1;
+        if ((used + 1) * 2 > slots.size()) grow();
+        size_t mask = slots.size() - 1;
+        for (size_t i = key & mask;; i = (i + 1) & mask) {
+            if (slots[i] == key) return false;
+            if (slots[i] == 0) { slots[i] = key; used++; return true; }
+        }
+    }
+
+private:
+    void grow() {
+        std::vector<uint64_t> old(slots.size() * 2, 0);
+        old.swap(slots);
+        used = 0;
+        for (uint64_t key : old) if (key) insert(key);
+    }
+};
+
+// Hash do que o formato guarda (sem roque/en passant): igual ao recalculado
+// ao retomar a partir do arquivo
+uint64_t packed_key(const PackedPosition& packed) {
+    return ChessBoard(unpack_fen(packed)).get_hash();
+}
+
+class DataWriter {
+private:
+    std::mutex mutex;
+    std::ofstream out;
+    HashSet seen;
+    uint64_t written = 0;
+    uint64_t duplicates = 0;
+    uint64_t target;
+
+public:
+    explicit DataWriter(uint64_t target_positions) : target(target_positions) {}
+
+    // Abre (ou cria) o arquivo; registros já gravados entram no índice de duplicatas
+    bool open(const std::string& path) {
+        std::error_code ec;
+        uintmax_t size = std::filesystem::exists(path, ec) ? std::filesystem::file_size(path, ec) : 0;
+        const uintmax_t header = 4 + sizeof(TRAINING_DATA_VERSION);
+
+        if (size >= header) {
+            std::ifstream in(path, std::ios::binary);
+            char magic[4] = {};
+            uint32_t version = 0;
+            in.read(magic, 4);
+            in.read(reinterpret_cast<char*>(&version), sizeof(version));
+            if (std::memcmp(magic, TRAINING_DATA_MAGIC, 4) != 0 || version != TRAINING_DATA_VERSION) {
+                std::cerr << path << " nao e um arquivo de dados valido" << std::endl;
+                return false;
+            }
+            std::vector<PackedPosition> records(FLUSH_POSITIONS);
+            while (in) {
+                in.read(reinterpret_cast<char*>(records.data()), records.size() * sizeof(PackedPosition));
+                size_t n = in.gcount() / sizeof(PackedPosition);
+                for (size_t i = 0; i < n; i++) seen.insert(packed_key(records[i]));
+                written += n;
+            }
+            in.close();
+            // Interrupção no meio de um registro: descarta o pedaço
+            uintmax_t whole = header + written * sizeof(PackedPosition);
+            if (whole != size) std::filesystem::resize_file(path, whole, ec);
+            out.open(path, std::ios::binary | std::ios::app);
+            std::cout << "Retomando " << path << ": " << written << " posicoes" << std::endl;
+        } else {
+            out.open(path, std::ios::binary | std::ios::trunc);
+            out.write(TRAINING_DATA_MAGIC, 4);
+            out.write(reinterpret_cast<const char*>(&TRAINING_DATA_VERSION), sizeof(TRAINING_DATA_VERSION));
+        }
+        return (bool)out;
+    }
+
+    bool done() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return written >= target;
+    }
+
+    uint64_t count() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return written;
+    }
+
+    uint64_t duplicate_count() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return duplicates;
+    }
+
+    // Grava o buffer de uma thread (sem duplicatas, até o alvo) e o esvazia
+    void flush(std::vector<Sample>& buffer) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const Sample& sample : buffer) {
+            if (written >= target) break;
+            if (!seen.insert(sample.key)) { duplicates++; continue; }
+            out.write(reinterpret_cast<const char*>(&sample.packed), sizeof(sample.packed));
+            written++;
+        }
+        out.flush();
+        buffer.clear();
+    }
+};
+
+// Joga uma partida e acrescenta as posições quietas (já com resultado) em samples.
+// false se a abertura aleatória foi descartada.
+bool play_game(ChessEngine& engine, const GenOptions& options, std::mt19937_64& rng, std::vector<Sample>& samples) {
+    ChessBoard board;
+    for (int ply = 0; ply < options.random_plies; ply++) {
+        std::vector<Move> legal = board.generate_legal_moves();
+        if (legal.empty()) return false;
+        board.make_move(legal[rng() % legal.size()]);
+    }
+    if (board.generate_legal_moves().empty()) return false;
+
+    engine.new_game();
+    SearchLimits limits;
+    limits.nodes = options.nodes;
+    limits.move_overhead = 0;
+
+    std::vector<Sample> game;
+    std::vector<uint64_t> hashes = { board.get_hash() };
+    int result = 1; // Brancas: 0 derrota, 1 empate, 2 vitória
+    int win_plies = 0, draw_plies = 0;
+
+    for (int ply = 0;; ply++) {
+        if (interrupted) return false;
+        Color us = board.get_side_to_move();
+        std::vector<Move> legal = board.generate_legal_moves();
+        if (legal.empty()) {
+            result = board.is_check(us) ? (us == WHITE ? 0 : 2) : 1;
+            break;
+        }
+        if (board.get_halfmove_clock() >= 100 || insufficient_material(board) || ply >= MAX_GAME_PLIES ||
+            std::count(hashes.begin(), hashes.end(), board.get_hash()) >= 3) break;
+
+        Move best = engine.get_best_move(board, limits);
+        if (best.from == NO_SQUARE) break;
+        int score = engine.get_search_stats().score;
+        int white_score = (us == WHITE) ? score : -score;
+        bool mate = ChessEngine::mate_in(score) != 0;
+
+        // Abertura aleatória muito desequilibrada não gera dados úteis
+        if (ply == 0 && std::abs(score) > options.max_opening_score) return false;
+
+        bool quiet = !board.is_check(us) && !mate && best.promotion == NONE &&
+                     !best.is_en_passant && board.get_piece(best.to) == NONE;
+        if (quiet) {
+            Sample sample;
+            if (pack_position(board, 1, ChessEngine::score_to_cp(white_score), sample.packed)) {
+                sample.key = packed_key(sample.packed);
+                game.push_back(sample);
+            }
+        }
+
+        // Adjudicação: evita gastar nós em finais decididos ou mortos
+        win_plies = (mate || std::abs(score) >= WIN_ADJUDICATION_SCORE) ? win_plies + 1 : 0;
+        if (win_plies >= WIN_ADJUDICATION_PLIES) { result = (white_score > 0) ? 2 : 0; break; }
+        draw_plies = (ply >= DRAW_ADJUDICATION_PLY && std::abs(score) <= DRAW_ADJUDICATION_SCORE) ? draw_plies + 1 : 0;
+        if (draw_plies >= DRAW_ADJUDICATION_PLIES) { result = 1; break; }
+
+        board.make_move(best);
+        hashes.push_back(board.get_hash());
+    }
+
+    for (Sample& sample : game) {
+        sample.packed.result = (uint8_t)result;
+        samples.push_back(sample);
+    }
+    return true;
+}
+
+bool parse_options(const std::vector<std::string>& args, GenOptions& options) {
+    if (args.empty() || args[0].rfind("--", 0) == 0) return false;
+    options.output = args[0];
+    for (size_t i = 1; i < args.size(); i += 2) {
+        if (i + 1 >= args.size()) { std::cerr << "Falta o valor de " << args[i] << std::endl; return false; }
+        const std::string& value = args[i + 1];
+        if (args[i] == "--positions") options.positions = std::strtoull(value.c_str(), nullptr, 10);
+        else if (args[i] == "--threads") options.threads = std::max(1, std::atoi(value.c_str()));
+        else if (args[i] == "--nodes") options.nodes = std::max<uint64_t>(1, std::strtoull(value.c_str(), nullptr, 10));
+        else if (args[i] == "--random-plies") options.random_plies = std::max(0, std::atoi(value.c_str()));
+        else if (args[i] == "--max-opening-score") options.max_opening_score = std::max(0, std::atoi(value.c_str()));
+        else if (args[i] == "--hash") options.hash_mb = std::max(1, std::atoi(value.c_str()));
+        else if (args[i] == "--seed") options.seed = std::strtoull(value.c_str(), nullptr, 10);
+        else if (args[i] == "--network") options.network = value;
+        else { std::cerr << "Opcao desconhecida: " << args[i] << std::endl; return false; }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    GenOptions options;
+    options.threads = std::max(1u, std::thread::hardware_concurrency());
+    options.seed = std::chrono::steady_clock::now().time_since_epoch().count();
+    if (!parse_options(std::vector<std::string>(argv + 1, argv + argc), options)) {
+        std::cerr << "Uso:\n"
+                  << "  datagen <saida.bin> [--positions N] [--threads N] [--nodes N] [--random-plies N]\n"
+                  << "          [--max-opening-score CP] [--hash MB] [--seed S] [--network ARQ]" << std::endl;
+        return 1;
+    }
+
+    // Scores da avaliação manual, a menos que uma rede seja pedida
+    std::shared_ptr<NNUENetwork> network;
+    if (!options.network.empty()) {
+        network = std::make_shared<NNUENetwork>();
+        if (!network->load(options.network)) {
+            std::cerr << "Nao foi possivel carregar a rede " << options.network << std::endl;
+            return 1;
+        }
+    }
+
+    DataWriter writer(options.positions);
+    if (!writer.open(options.output)) return 1;
+    const uint64_t resumed = writer.count();
+
+    // Ctrl+C: as threads gravam o que têm e o arquivo pode ser retomado
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+
+    std::atomic<uint64_t> games{ 0 };
+    auto start = std::chrono::steady_clock::now();
+
+    auto worker = [&](int id) {
+        ChessEngine engine;
+        engine.set_silent(true);
+        engine.set_network(network);
+        engine.set_hash_size(options.hash_mb);
+        // Ao retomar com a mesma semente, as partidas não se repetem
+        std::mt19937_64 rng(options.seed ^ (0x9E3779B97F4A7C15ULL * (id + 1)) ^ (resumed * 0xBF58476D1CE4E5B9ULL));
+
+        std::vector<Sample> buffer;
+        auto last_flush = std::chrono::steady_clock::now();
+        while (!interrupted && !writer.done()) {
+            if (play_game(engine, options, rng, buffer)) games++;
+            auto now = std::chrono::steady_clock::now();
+            if (buffer.size() >= FLUSH_POSITIONS || now - last_flush >= std::chrono::seconds(FLUSH_SECONDS)) {
+                writer.flush(buffer);
+                last_flush = now;
+            }
+        }
+        writer.flush(buffer);
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 0; t < options.threads; t++) pool.emplace_back(worker, t);
+
+    // Progresso
+    auto last_report = start;
+    while (!writer.done() && !interrupted) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        auto now = std::chrono::steady_clock::now();
+        if (now - last_report < std::chrono::seconds(10)) continue;
+        last_report = now;
+        double seconds = std::chrono::duration<double>(now - start).count();
+        uint64_t count = writer.count();
+        std::cout << "Posicoes: " << count << "/" << options.positions << "  partidas: " << games
+                  << "  " << (uint64_t)((count - resumed) / seconds) << " pos/s" << std::endl;
+    }
+    for (auto& th : pool) th.join();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Posicoes gravadas: " << writer.count() - resumed << " (total " << writer.count() << ")"
+              << "  partidas: " << games << "  duplicatas: " << writer.duplicate_count()
+              << "  tempo: " << (uint64_t)seconds << " s" << std::endl;
+    if (interrupted) std::cout << "Interrompido: rode o mesmo comando para continuar" << std::endl;
+    return 0;
+}
@@ -0,0 +1,849 @@
+#include "distributed.h"
+#include "batch.h"
+#include "chess_engine.h"
+#include "game_rules.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <deque>
+#include <map>
+#include <list>
+#include <algorithm>
+#include <filesystem>
+#include <cstdlib>
+#include <csignal>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <cerrno>
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const int POLL_MS = 200;                 // Intervalo para conferir leases e SIGINT/SIGTERM
+const int WAIT_MS = 500;                 // Worker sem lote pede de novo depois disso
+const int SEND_TIMEOUT_S = 10;           // Worker que não lê o socket é desconectado
+const int REPORT_SECONDS = 10;
+const size_t MAX_OUTSTANDING = 1 << 16;  // Itens lidos e ainda não gravados (limita a memória)
+const int ITEMS_PER_THREAD = 4;          // Tamanho padrão do lote
+const int ABORT_RETRY_MS = 10;           // Intervalo entre stops ao abandonar um lease
+
+std::atomic<bool> interrupted{ false };
+
+void on_signal(int) { interrupted = true; }
+
+#ifndef _WIN32
+
+// Uma partida da engine contra ela mesma a partir da abertura da linha.
+// scores: resultado de cada busca, centipawns do ponto de vista das brancas.
+// cancel é conferido a cada lance: o stop da engine só encerra a busca atual
+std::string selfplay_game(ChessEngine& engine, size_t index, const std::string& line, const SearchLimits& limits,
+                          const std::atomic<bool>& cancel) {
+    std::ostringstream json;
+    json << "{\"index\":" << index;
+
+    std::string fen = START_FEN, id;
+    ChessBoard board;
+    bool ok = (line == "startpos") || parse_epd(line, fen, id);
+    if (ok) {
+        board.from_fen(fen);
+        ok = valid_position(board);
+    }
+    if (!id.empty()) json << ",\"id\":\"" << json_escape(id) << "\"";
+    if (!ok) {
+        json << ",\"input\":\"" << json_escape(line) << "\",\"error\":\"invalid position\"}";
+        return json.str();
+    }
+
+    engine.new_game();
+    std::vector<uint64_t> hashes = { board.get_hash() };
+    std::string moves, scores, result = "1/2-1/2", termination;
+    uint64_t nodes = 0;
+    int win_plies = 0, draw_plies = 0;
+    for (int ply = 0;; ply++) {
+        Color us = board.get_side_to_move();
+        if (cancel) { termination = "aborted"; break; }
+        if (board.generate_legal_moves().empty()) {
+            bool mate = board.is_check(us);
+            if (mate) result = (us == WHITE) ? "0-1" : "1-0";
+            termination = mate ? "checkmate" : "stalemate";
+            break;
+        }
+        if (board.get_halfmove_clock() >= 100) { termination = "fifty moves"; break; }
+        if (std::count(hashes.begin(), hashes.end(), board.get_hash()) >= 3) { termination = "repetition"; break; }
+        if (insufficient_material(board)) { termination = "insufficient material"; break; }
+        if (ply >= MAX_GAME_PLIES) { termination = "max plies"; break; }
+
+        Move best = engine.get_best_move(board, limits);
+        if (best.from == NO_SQUARE) { termination = "aborted"; break; }
+        int score = engine.get_search_stats().score;
+        int white_score = (us == WHITE) ? score : -score;
+        nodes += engine.get_search_stats().nodes;
+        moves += (ply ? ",\"" : "\"") + best.to_string() + "\"";
+        scores += (ply ? "," : "") + std::to_string(ChessEngine::score_to_cp(white_score));
+
+        board.make_move(best);
+        hashes.push_back(board.get_hash());
+        win_plies = (ChessEngine::mate_in(score) || std::abs(score) >= WIN_ADJUDICATION_SCORE) ? win_plies + 1 : 0;
+        if (win_plies >= WIN_ADJUDICATION_PLIES) {
+            result = (white_score > 0) ? "1-0" : "0-1";
+            termination = "adjudication";
+            break;
+        }
+        draw_plies = (ply >= DRAW_ADJUDICATION_PLY && std::abs(score) <= DRAW_ADJUDICATION_SCORE) ? draw_plies + 1 : 0;
+        if (draw_plies >= DRAW_ADJUDICATION_PLIES) { termination = "adjudication"; break; }
+    }
+
+    json << ",\"fen\":\"" << fen << "\",\"result\":\"" << result << "\",\"termination\":\"" << termination
+         << "\",\"nodes\":" << nodes << ",\"moves\":[" << moves << "],\"scores\":[" << scores << "]}";
+    return json.str();
+}
+
+// Socket com buffer de leitura por linhas; escrita serializada (várias threads no worker)
+class Connection {
+private:
+    int fd;
+    std::mutex write_mutex;
+    std::atomic<bool> open{ true };
+    std::string buffer;
+
+public:
+    explicit Connection(int fd) : fd(fd) {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)); // Pedido/lease são linhas curtas
+        timeval timeout = { SEND_TIMEOUT_S, 0 };
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    ~Connection() { close(fd); }
+
+    int socket() const { return fd; }
+    bool is_open() const { return open; }
+
+    // Uma ou mais linhas completas; erro de escrita fecha a conexão
+    bool send(const std::string& data) {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        size_t written = 0;
+        while (open && written < data.size()) {
+            ssize_t n = write(fd, data.data() + written, data.size() - written);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) { open = false; break; }
+            written += (size_t)n;
+        }
+        return open;
+    }
+
+    // Lê o que houver no socket; false em EOF ou erro
+    bool receive() {
+        char chunk[4096];
+        ssize_t n;
+        do n = read(fd, chunk, sizeof(chunk)); while (n < 0 && errno == EINTR);
+        if (n <= 0) { open = false; return false; }
+        buffer.append(chunk, (size_t)n);
+        return true;
+    }
+
+    bool next_line(std::string& line) {
+        size_t newline = buffer.find('\n');
+        if (newline == std::string::npos) return false;
+        line = buffer.substr(0, newline);
+        buffer.erase(0, newline + 1);
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        return true;
+    }
+
+    // Há algo para ler (ou EOF) sem bloquear
+    bool readable() const {
+        pollfd pfd = { fd, POLLIN, 0 };
+        return poll(&pfd, 1, 0) > 0;
+    }
+
+    // Bloqueia até a próxima linha
+    bool read_line(std::string& line) {
+        while (!next_line(line)) {
+            if (!receive()) return false;
+        }
+        return true;
+    }
+};
+
+std::string describe_peer(int fd) {
+    sockaddr_in addr = {};
+    socklen_t size = sizeof(addr);
+    char host[INET_ADDRSTRLEN] = "?";
+    if (getpeername(fd, (sockaddr*)&addr, &size) == 0) inet_ntop(AF_INET, &addr.sin_addr, host, sizeof(host));
+    return std::string(host) + ":" + std::to_string(ntohs(addr.sin_port));
+}
+
+// ---------------------------------------------------------------------------
+// Coordenador: um único thread com poll(); todo o estado fica aqui
+
+struct WorkItem {
+    std::string line;
+    std::string result;
+    uint64_t lease = 0; // 0 = na fila ou concluído
+    int attempts = 0;
+    bool done = false;
+};
+
+struct WorkerSlot {
+    std::unique_ptr<Connection> connection;
+    std::string peer;
+    int threads = 1;
+    uint64_t completed = 0;
+};
+
+struct Lease {
+    WorkerSlot* worker;
+    std::vector<size_t> items;
+    Clock::time_point deadline;
+};
+
+class Coordinator {
+private:
+    const CoordinatorOptions& options;
+    SearchLimits limits;
+    std::ifstream input;
+    std::ofstream output;
+    bool input_done = false;
+    size_t next_index = 0;              // Índice do próximo item lido
+    size_t next_to_write = 0;
+    std::map<size_t, WorkItem> items;   // Lidos e ainda não gravados
+    std::deque<size_t> pending;         // Prontos para entregar (re-despachos na frente)
+    std::map<uint64_t, Lease> leases;
+    uint64_t next_lease = 1;
+    std::list<WorkerSlot> workers;
+
+    size_t resumed = 0;
+    uint64_t dispatched = 0, redispatched = 0, expired = 0, duplicates = 0, failed = 0;
+
+public:
+    explicit Coordinator(const CoordinatorOptions& options) : options(options) {
+        limits.depth = options.depth;
+        limits.nodes = options.nodes;
+        limits.movetime = options.movetime;
+        limits.move_overhead = 0;
+        if (limits.depth == 0 && limits.nodes == 0 && limits.movetime < 0) {
+            if (options.mode == "selfplay") limits.nodes = SELFPLAY_DEFAULT_NODES;
+            else limits.depth = BATCH_DEFAULT_DEPTH;
+        }
+    }
+
+    // Abre a entrada e a saída; pula os itens que já estão no arquivo de saída
+    bool open(std::string& error) {
+        input.open(options.input);
+        if (!input) { error = "nao foi possivel abrir " + options.input; return false; }
+
+        std::error_code ec;
+        if (std::filesystem::exists(options.output, ec)) {
+            std::ifstream previous(options.output, std::ios::binary);
+            std::string line;
+            uintmax_t complete_bytes = 0;
+            while (std::getline(previous, line) && !previous.eof()) {
+                complete_bytes += line.size() + 1;
+                resumed++;
+            }
+            previous.close();
+            // Linha interrompida no meio: descarta o pedaço
+            std::filesystem::resize_file(options.output, complete_bytes, ec);
+            for (size_t skipped = 0; skipped < resumed && read_line(line);) skipped++;
+            next_index = next_to_write = resumed;
+        }
+        output.open(options.output, std::ios::app);
+        if (!output) { error = "nao foi possivel abrir " + options.output; return false; }
+        if (resumed) std::cerr << "Retomando " << options.output << ": " << resumed << " itens" << std::endl;
+        return true;
+    }
+
+    bool finished() {
+        if (items.empty() && !input_done) refill(1);
+        return items.empty() && input_done;
+    }
+
+    std::vector<pollfd> poll_list(int listener) const {
+        std::vector<pollfd> fds = { { listener, POLLIN, 0 } };
+        for (const WorkerSlot& worker : workers) fds.push_back({ worker.connection->socket(), POLLIN, 0 });
+        return fds;
+    }
+
+    void add_worker(int fd) {
+        workers.emplace_back();
+        workers.back().connection = std::make_unique<Connection>(fd);
+        workers.back().peer = describe_peer(fd);
+    }
+
+    // Lê e trata as linhas de cada worker com dados; remove os que caíram
+    void service(const std::vector<pollfd>& fds) {
+        for (auto it = workers.begin(); it != workers.end();) {
+            auto ready = std::find_if(fds.begin() + 1, fds.end(), [&](const pollfd& p) { return p.fd == it->connection->socket(); });
+            bool alive = it->connection->is_open();
+            if (alive && ready != fds.end() && (ready->revents & (POLLIN | POLLHUP | POLLERR))) {
+                alive = it->connection->receive();
+                // Linhas que chegaram antes do EOF ainda contam (resultados de um worker que caiu)
+                std::string line;
+                while (it->connection->next_line(line)) handle(*it, line);
+                alive = alive && it->connection->is_open();
+            }
+            if (!alive) {
+                std::cerr << "Worker " << it->peer << " desconectado (" << it->completed << " itens)" << std::endl;
+                release_worker(&*it);
+                it = workers.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    // Leases sem notícia dentro do prazo voltam para a fila
+    void expire_leases() {
+        auto now = Clock::now();
+        for (auto it = leases.begin(); it != leases.end();) {
+            if (it->second.deadline > now) { ++it; continue; }
+            std::cerr << "Lease " << it->first << " expirou (worker " << it->second.worker->peer << ")" << std::endl;
+            expired++;
+            release(it->first, it->second);
+            it = leases.erase(it);
+        }
+    }
+
+    // Interrompido: só fecha as conexões, e os workers tentam reconectar
+    void close_workers(bool finished) {
+        if (finished) {
+            for (WorkerSlot& worker : workers) worker.connection->send("finished\n");
+        }
+        workers.clear();
+    }
+
+    void report(Clock::time_point start, bool final) const {
+        int64_t seconds = std::chrono::duration_cast<std::chrono::seconds>(Clock::now() - start).count();
+        if (!final) {
+            std::cerr << "Itens gravados: " << next_to_write << "  workers: " << workers.size() << "  leases: " << leases.size()
+                      << "  pendentes: " << pending.size() << "  (" << seconds << " s)" << std::endl;
+            return;
+        }
+        std::cerr << "Itens           : " << next_to_write << (resumed ? " (" + std::to_string(resumed) + " retomados)" : "") << "\n"
+                  << "Leases          : " << next_lease - 1 << " (" << expired << " expirados)\n"
+                  << "Re-despachados  : " << redispatched << "\n"
+                  << "Duplicados      : " << duplicates << "\n"
+                  << "Falhas          : " << failed << "\n"
+                  << "Tempo total (s) : " << seconds << std::endl;
+    }
+
+private:
+    bool read_line(std::string& line) {
+        while (std::getline(input, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.find_first_not_of(" \t") == std::string::npos || line[0] == '#') continue;
+            return true;
+        }
+        return false;
+    }
+
+    // Lê da entrada até haver `wanted` itens na fila (ou a janela encher)
+    void refill(size_t wanted) {
+        std::string line;
+        while (!input_done && pending.size() < wanted && items.size() < MAX_OUTSTANDING) {
+            if (!read_line(line)) { input_done = true; break; }
+            items[next_index].line = line;
+            pending.push_back(next_index++);
+        }
+    }
+
+    void handle(WorkerSlot& worker, const std::string& line) {
+        std::istringstream ss(line);
+        std::string command;
+        ss >> command;
+        if (command == "hello") {
+            ss >> worker.threads;
+            worker.threads = std::max(1, worker.threads);
+            std::ostringstream welcome;
+            welcome << "welcome " << options.mode << " " << limits.depth << " " << limits.nodes << " " << limits.movetime
+                    << " " << options.lease_timeout * 1000 / 4 << "\n";
+            worker.connection->send(welcome.str());
+            std::cerr << "Worker " << worker.peer << " conectado (" << worker.threads << " threads)" << std::endl;
+        } else if (command == "request") {
+            dispatch(worker);
+        } else if (command == "result") {
+            uint64_t lease = 0;
+            size_t index = 0;
+            std::string json;
+            if (!(ss >> lease >> index)) return;
+            std::getline(ss >> std::ws, json);
+            record(worker, lease, index, json);
+        } else if (command == "heartbeat") {
+            uint64_t lease = 0;
+            ss >> lease;
+            auto it = leases.find(lease);
+            if (it != leases.end() && it->second.worker == &worker) it->second.deadline = Clock::now() + std::chrono::seconds(options.lease_timeout);
+        } else if (command == "done") {
+            uint64_t lease = 0;
+            ss >> lease;
+            auto it = leases.find(lease);
+            if (it != leases.end() && it->second.worker == &worker) {
+                release(it->first, it->second); // Só sobra algo se o worker pulou itens
+                leases.erase(it);
+            }
+        }
+    }
+
+    void dispatch(WorkerSlot& worker) {
+        size_t size = options.batch > 0 ? (size_t)options.batch : (size_t)worker.threads * ITEMS_PER_THREAD;
+        refill(size);
+        if (pending.empty()) {
+            worker.connection->send(finished() ? "finished\n" : "wait " + std::to_string(WAIT_MS) + "\n");
+            return;
+        }
+
+        uint64_t id = next_lease++;
+        Lease& lease = leases[id];
+        lease.worker = &worker;
+        lease.deadline = Clock::now() + std::chrono::seconds(options.lease_timeout);
+        std::string body;
+        while (!pending.empty() && lease.items.size() < size) {
+            size_t index = pending.front();
+            pending.pop_front();
+            WorkItem& item = items[index];
+            item.lease = id;
+            if (item.attempts) redispatched++;
+            lease.items.push_back(index);
+            body += "item " + std::to_string(index) + " " + item.line + "\n";
+        }
+        dispatched += lease.items.size();
+        worker.connection->send("lease " + std::to_string(id) + " " + std::to_string(lease.items.size()) + "\n" + body);
+    }
+
+    // O primeiro resultado de cada item vale, venha de um lease vencido ou não
+    void record(WorkerSlot& worker, uint64_t lease, size_t index, const std::string& json) {
+        auto lease_it = leases.find(lease);
+        if (lease_it != leases.end() && lease_it->second.worker == &worker) {
+            lease_it->second.deadline = Clock::now() + std::chrono::seconds(options.lease_timeout);
+        }
+        auto it = items.find(index);
+        if (it == items.end() || it->second.done || json.empty() || json[0] != '{') { duplicates++; return; }
+        if (it->second.lease == 0) {
+            // Estava de volta na fila: tira para não entregar de novo
+            auto queued = std::find(pending.begin(), pending.end(), index);
+            if (queued != pending.end()) pending.erase(queued);
+        }
+        it->second.result = json;
+        it->second.done = true;
+        it->second.lease = 0;
+        worker.completed++;
+        write_ready();
+    }
+
+    // Itens do lease ainda sem resultado voltam para a frente da fila
+    void release(uint64_t id, const Lease& lease) {
+        for (auto index = lease.items.rbegin(); index != lease.items.rend(); ++index) {
+            auto it = items.find(*index);
+            if (it == items.end() || it->second.done || it->second.lease != id) continue;
+            WorkItem& item = it->second;
+            item.lease = 0;
+            if (++item.attempts >= options.max_attempts) {
+                item.result = "{\"index\":" + std::to_string(*index) + ",\"input\":\"" + json_escape(item.line) +
+                              "\",\"error\":\"failed after " + std::to_string(item.attempts) + " attempts\"}";
+                item.done = true;
+                failed++;
+            } else {
+                pending.push_front(*index);
+            }
+        }
+        write_ready();
+    }
+
+    void release_worker(WorkerSlot* worker) {
+        for (auto it = leases.begin(); it != leases.end();) {
+            if (it->second.worker != worker) { ++it; continue; }
+            release(it->first, it->second);
+            it = leases.erase(it);
+        }
+    }
+
+    // Grava o prefixo contíguo de itens concluídos
+    void write_ready() {
+        bool wrote = false;
+        for (auto it = items.begin(); it != items.end() && it->first == next_to_write && it->second.done; it = items.erase(it)) {
+            output << it->second.result << '\n';
+            next_to_write++;
+            wrote = true;
+        }
+        if (wrote) output.flush();
+    }
+};
+
+int open_listener(const CoordinatorOptions& options, std::string& error) {
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)options.port);
+    if (inet_pton(AF_INET, options.bind.c_str(), &addr.sin_addr) != 1) { error = "endereco de bind invalido " + options.bind; return -1; }
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) { error = "falha ao criar o socket"; return -1; }
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0) { error = "nao foi possivel usar " + options.bind + ":" + std::to_string(options.port); close(fd); return -1; }
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    if (listen(fd, 64) < 0) { error = "falha no listen"; close(fd); return -1; }
+    return fd;
+}
+
+// ---------------------------------------------------------------------------
+// Worker: threads com uma ChessEngine cada, vivas entre leases e reconexões
+
+class WorkerPool {
+private:
+    std::mutex mutex;
+    std::condition_variable work_cv;
+    std::condition_variable done_cv;
+    std::deque<std::pair<size_t, std::string>> queue;
+    std::vector<ChessEngine*> engines;
+    std::vector<std::thread> threads;
+    size_t remaining = 0;       // Itens do lease atual ainda sem resultado
+    bool stopping = false;
+    bool discard = false;       // Buscas interrompidas por abort(): resultado não vale
+    std::atomic<bool> cancelled{ false }; // abort(): partidas de self-play param no próximo lance
+
+    // Configuração do lease atual (protegida por mutex)
+    Connection* connection = nullptr;
+    uint64_t lease = 0;
+    bool selfplay = false;
+    SearchLimits limits;
+
+public:
+    WorkerPool(int count, size_t hash_mb, std::shared_ptr<NNUENetwork> network) {
+        for (int t = 0; t < count; t++) {
+            threads.emplace_back([this, count, hash_mb, network] { run(std::max<size_t>(1, hash_mb / count), network); });
+        }
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        work_cv.notify_all();
+        for (auto& th : threads) th.join();
+    }
+
+    void start(Connection* conn, uint64_t id, bool is_selfplay, const SearchLimits& search_limits,
+               std::vector<std::pair<size_t, std::string>>& lease_items) {
+        std::lock_guard<std::mutex> lock(mutex);
+        connection = conn;
+        lease = id;
+        selfplay = is_selfplay;
+        limits = search_limits;
+        remaining = lease_items.size();
+        discard = false;
+        cancelled = false;
+        for (auto& item : lease_items) queue.push_back(std::move(item));
+        work_cv.notify_all();
+    }
+
+    // true quando o lease terminou; false se o prazo passou antes
+    bool wait_for(int ms) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return done_cv.wait_for(lock, std::chrono::milliseconds(ms), [&] { return remaining == 0; });
+    }
+
+    // Conexão perdida: descarta a fila, interrompe as buscas e espera as threads.
+    // O stop é repetido: um que chegue antes de get_best_move começar se perde
+    void abort() {
+        std::unique_lock<std::mutex> lock(mutex);
+        remaining -= queue.size();
+        queue.clear();
+        discard = true;
+        cancelled = true;
+        do {
+            for (ChessEngine* engine : engines) engine->stop();
+        } while (!done_cv.wait_for(lock, std::chrono::milliseconds(ABORT_RETRY_MS), [&] { return remaining == 0; }));
+    }
+
+private:
+    void run(size_t hash_mb, std::shared_ptr<NNUENetwork> network) {
+        ChessEngine engine;
+        engine.set_silent(true);
+        engine.set_network(network);
+        engine.set_hash_size(hash_mb);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            engines.push_back(&engine);
+        }
+
+        while (true) {
+            std::pair<size_t, std::string> item;
+            Connection* conn;
+            uint64_t id;
+            bool is_selfplay;
+            SearchLimits search_limits;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                work_cv.wait(lock, [&] { return !queue.empty() || stopping; });
+                if (stopping) break;
+                item = std::move(queue.front());
+                queue.pop_front();
+                conn = connection;
+                id = lease;
+                is_selfplay = selfplay;
+                search_limits = limits;
+            }
+
+            std::string json = is_selfplay ? selfplay_game(engine, item.first, item.second, search_limits, cancelled)
+                                           : analyse_epd(engine, item.first, item.second, search_limits);
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!discard) conn->send("result " + std::to_string(id) + " " + std::to_string(item.first) + " " + json + "\n");
+            if (--remaining == 0) done_cv.notify_all();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        engines.erase(std::find(engines.begin(), engines.end(), &engine));
+    }
+};
+
+int connect_to(const std::string& host, int port) {
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* found = nullptr;
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &found) != 0) return -1;
+    int fd = -1;
+    for (addrinfo* ai = found; ai && fd < 0; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd >= 0 && connect(fd, ai->ai_addr, ai->ai_addrlen) < 0) { close(fd); fd = -1; }
+    }
+    freeaddrinfo(found);
+    return fd;
+}
+
+// Lê sem bloquear o que o coordenador já mandou; true se ele encerrou o trabalho
+// (pode ter chegado enquanto as buscas rodavam ou depois de um write falhar)
+bool received_finished(Connection& conn) {
+    std::string line;
+    bool finished = false;
+    while (true) {
+        while (conn.next_line(line)) finished = finished || line == "finished";
+        if (!conn.readable() || !conn.receive()) return finished;
+    }
+}
+
+// Uma sessão com o coordenador; true se ele mandou "finished"
+bool worker_session(Connection& conn, WorkerPool& pool, const WorkerOptions& options) {
+    std::string line;
+    if (!conn.send("hello " + std::to_string(options.threads) + "\n") || !conn.read_line(line)) return false;
+
+    std::istringstream welcome(line);
+    std::string command, mode;
+    SearchLimits limits;
+    limits.move_overhead = 0;
+    int heartbeat_ms = 0;
+    if (!(welcome >> command >> mode >> limits.depth >> limits.nodes >> limits.movetime >> heartbeat_ms) || command != "welcome") {
+        std::cerr << "worker: resposta inesperada: " << line << std::endl;
+        return false;
+    }
+    if (mode != "analyze" && mode != "selfplay") {
+        std::cerr << "worker: modo desconhecido " << mode << std::endl;
+        return false;
+    }
+    heartbeat_ms = std::max(100, heartbeat_ms);
+    std::cerr << "Conectado a " << options.host << ":" << options.port << " (" << mode << ")" << std::endl;
+
+    while (!interrupted && conn.send("request\n") && conn.read_line(line)) {
+        std::istringstream ss(line);
+        ss >> command;
+        if (command == "finished") return true;
+        if (command == "wait") {
+            int ms = WAIT_MS;
+            ss >> ms;
+            std::this_thread::sleep_for(std::chrono::milliseconds(std::max(1, ms)));
+            continue;
+        }
+        uint64_t lease = 0;
+        size_t count = 0;
+        if (command != "lease" || !(ss >> lease >> count)) {
+            std::cerr << "worker: resposta inesperada: " << line << std::endl;
+            return false;
+        }
+
+        std::vector<std::pair<size_t, std::string>> items;
+        for (size_t i = 0; i < count; i++) {
+            if (!conn.read_line(line)) return false;
+            std::istringstream item(line);
+            size_t index = 0;
+            std::string rest;
+            if (!(item >> command >> index) || command != "item") continue;
+            std::getline(item >> std::ws, rest);
+            items.emplace_back(index, rest);
+        }
+
+        pool.start(&conn, lease, mode == "selfplay", limits, items);
+        auto next_heartbeat = Clock::now() + std::chrono::milliseconds(heartbeat_ms);
+        while (!pool.wait_for(std::min(POLL_MS, heartbeat_ms))) {
+            // Outro worker terminou os itens re-despachados deste lease e o coordenador
+            // encerrou, ou a conexão caiu (EOF): abandona o lease sem esperar o heartbeat
+            bool finished = received_finished(conn);
+            bool lost = !conn.is_open();
+            if (!lost && Clock::now() >= next_heartbeat) {
+                lost = !conn.send("heartbeat " + std::to_string(lease) + "\n");
+                next_heartbeat = Clock::now() + std::chrono::milliseconds(heartbeat_ms);
+            }
+            if (finished || interrupted || lost) {
+                pool.abort();
+                return finished;
+            }
+        }
+        conn.send("done " + std::to_string(lease) + "\n");
+    }
+    return received_finished(conn);
+}
+
+#endif // _WIN32
+
+} // namespace
+
+bool parse_coordinator_options(const std::vector<std::string>& args, CoordinatorOptions& options, std::string& error) {
+    for (size_t i = 0; i < args.size(); i++) {
+        const std::string& arg = args[i];
+        if (arg.rfind("--", 0) == 0 && i + 1 >= args.size()) { error = "falta o valor de " + arg; return false; }
+        if (arg == "--input") options.input = args[++i];
+        else if (arg == "--output") options.output = args[++i];
+        else if (arg == "--mode") options.mode = args[++i];
+        else if (arg == "--bind") options.bind = args[++i];
+        else if (arg == "--port") options.port = std::atoi(args[++i].c_str());
+        else if (arg == "--depth") options.depth = std::max(0, std::atoi(args[++i].c_str()));
+        else if (arg == "--nodes") options.nodes = std::strtoull(args[++i].c_str(), nullptr, 10);
+        else if (arg == "--movetime") options.movetime = std::atoi(args[++i].c_str());
+        else if (arg == "--batch") options.batch = std::max(0, std::atoi(args[++i].c_str()));
+        else if (arg == "--lease-timeout") options.lease_timeout = std::max(1, std::atoi(args[++i].c_str()));
+        else if (arg == "--max-attempts") options.max_attempts = std::max(1, std::atoi(args[++i].c_str()));
+        else { error = "opcao desconhecida " + arg; return false; }
+    }
+    if (options.input.empty() || options.output.empty()) { error = "--input e --output sao obrigatorios"; return false; }
+    if (options.mode != "analyze" && options.mode != "selfplay") { error = "modo desconhecido " + options.mode; return false; }
+    if (options.port <= 0 || options.port > 65535) { error = "porta invalida"; return false; }
+    return true;
+}
+
+bool parse_worker_options(const std::vector<std::string>& args, WorkerOptions& options, std::string& error) {
+    for (size_t i = 0; i < args.size(); i++) {
+        const std::string& arg = args[i];
+        if (arg.rfind("--", 0) == 0 && i + 1 >= args.size()) { error = "falta o valor de " + arg; return false; }
+        if (arg == "--connect") {
+            const std::string& address = args[++i];
+            size_t colon = address.rfind(':');
+            if (colon == std::string::npos) { options.host = address; continue; }
+            options.host = address.substr(0, colon);
+            options.port = std::atoi(address.substr(colon + 1).c_str());
+        }
+        else if (arg == "--threads") options.threads = std::max(1, std::atoi(args[++i].c_str()));
+        else if (arg == "--hash") options.hash_mb = std::max(1, std::atoi(args[++i].c_str()));
+        else if (arg == "--retry") options.retry = std::max(0, std::atoi(args[++i].c_str()));
+        else if (arg == "--network") options.network = args[++i];
+        else { error = "opcao desconhecida " + arg; return false; }
+    }
+    if (options.host.empty() || options.port <= 0 || options.port > 65535) { error = "endereco invalido"; return false; }
+    return true;
+}
+
+bool run_coordinator(const CoordinatorOptions& options) {
+#ifndef _WIN32
+    signal(SIGPIPE, SIG_IGN); // Worker que cai no meio de um write não derruba o coordenador
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+
+    Coordinator coordinator(options);
+    std::string error;
+    if (!coordinator.open(error)) {
+        std::cerr << "coordinator: " << error << std::endl;
+        return false;
+    }
+    int listener = open_listener(options, error);
+    if (listener < 0) {
+        std::cerr << "coordinator: " << error << std::endl;
+        return false;
+    }
+    std::cerr << "Coordenando " << options.mode << " de " << options.input << " em " << options.bind << ":" << options.port
+              << " (prazo do lease " << options.lease_timeout << " s)" << std::endl;
+
+    auto start = Clock::now(), last_report = start;
+    while (!interrupted && !coordinator.finished()) {
+        std::vector<pollfd> fds = coordinator.poll_list(listener);
+        int ready = poll(fds.data(), fds.size(), POLL_MS);
+        if (ready > 0 && (fds[0].revents & POLLIN)) {
+            int fd = accept(listener, nullptr, nullptr);
+            if (fd >= 0) coordinator.add_worker(fd);
+        }
+        if (ready > 0) coordinator.service(fds);
+        coordinator.expire_leases();
+
+        if (Clock::now() - last_report >= std::chrono::seconds(REPORT_SECONDS)) {
+            last_report = Clock::now();
+            coordinator.report(start, false);
+        }
+    }
+
+    // Interrompido: o que já foi gravado fica; rodar de novo retoma daí
+    coordinator.close_workers(!interrupted);
+    close(listener);
+    coordinator.report(start, true);
+    if (interrupted) std::cerr << "Interrompido: rode o mesmo comando para continuar" << std::endl;
+    return true;
+#else
+    (void)options;
+    std::cerr << "coordinator: nao suportado no Windows" << std::endl;
+    return false;
+#endif
+}
+
+bool run_worker(const WorkerOptions& options) {
+#ifndef _WIN32
+    signal(SIGPIPE, SIG_IGN);
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+
+    std::shared_ptr<NNUENetwork> network;
+    if (!options.network.empty()) {
+        network = std::make_shared<NNUENetwork>();
+        if (!network->load(options.network)) {
+            std::cerr << "worker: nao foi possivel carregar a rede " << options.network << std::endl;
+            return false;
+        }
+    }
+
+    WorkerPool pool(options.threads, options.hash_mb, network);
+    auto give_up = Clock::now() + std::chrono::seconds(options.retry);
+    while (!interrupted) {
+        int fd = connect_to(options.host, options.port);
+        if (fd < 0) {
+            if (Clock::now() >= give_up) {
+                std::cerr << "worker: nao foi possivel conectar a " << options.host << ":" << options.port << std::endl;
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+            continue;
+        }
+        Connection conn(fd);
+        if (worker_session(conn, pool, options)) return true;
+        // Coordenador caiu ou reiniciou: tenta de novo pelo mesmo prazo
+        if (!interrupted) std::cerr << "Conexao perdida, reconectando" << std::endl;
+        give_up = Clock::now() + std::chrono::seconds(options.retry);
+    }
+    return true;
+#else
+    (void)options;
+    std::cerr << "worker: nao suportado no Windows" << std::endl;
+    return false;
+#endif
+}
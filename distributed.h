@@ -0,0 +1,75 @@
+#ifndef DISTRIBUTED_H
+#define DISTRIBUTED_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Fila distribuída por TCP: um coordenador lê o arquivo de entrada e entrega
+// lotes a workers ("chess_uci worker") em outras máquinas; os resultados
+// voltam item a item e são gravados num único arquivo, na ordem da entrada.
+//
+// Modos (um por execução do coordenador):
+//   analyze  - cada linha é uma posição EPD/FEN; a saída é a linha JSON do batch
+//   selfplay - cada linha é uma abertura (EPD/FEN ou "startpos"); o worker joga
+//              a engine contra ela mesma e devolve lances, scores e resultado
+//
+// Cada lote é um lease com prazo, renovado por resultados e heartbeats. Lease
+// vencido ou worker desconectado devolve à fila os itens ainda sem resultado;
+// resultado repetido de um item re-despachado é descartado. Item que derruba
+// workers vira linha de erro depois de max_attempts tentativas. Se o arquivo
+// de saída já existir, o coordenador retoma depois das linhas já gravadas.
+//
+// Protocolo em linhas de texto (worker -> coordenador):
+//   hello <threads>
+//   request
+//   result <lease> <index> <json>
+//   heartbeat <lease>
+//   done <lease>
+// Coordenador -> worker:
+//   welcome <mode> <depth> <nodes> <movetime> <heartbeat_ms>
+//   lease <id> <count>, seguido de <count> linhas "item <index> <linha>"
+//   wait <ms>   (nada a entregar agora, há leases em andamento)
+//   finished
+// Sem autenticação: para redes confiáveis.
+const int DISTRIBUTED_DEFAULT_PORT = 7681;
+const uint64_t SELFPLAY_DEFAULT_NODES = 5000; // Partidas sem nenhum limite
+
+struct CoordinatorOptions {
+    std::string input;              // Arquivo EPD/FEN (obrigatório)
+    std::string output;             // Arquivo NDJSON (obrigatório)
+    std::string bind = "0.0.0.0";
+    int port = DISTRIBUTED_DEFAULT_PORT;
+    std::string mode = "analyze";   // analyze | selfplay
+    int depth = 0;                  // Limites por item (nenhum -> padrão do modo)
+    uint64_t nodes = 0;
+    int movetime = -1;
+    int batch = 0;                  // Itens por lease (0 = 4 por thread do worker)
+    int lease_timeout = 60;         // Segundos sem notícia do worker
+    int max_attempts = 3;
+};
+
+struct WorkerOptions {
+    std::string host = "127.0.0.1";
+    int port = DISTRIBUTED_DEFAULT_PORT;
+    int threads = 1;
+    size_t hash_mb = 64;            // TT total, dividida entre as threads
+    int retry = 30;                 // Segundos tentando (re)conectar
+    std::string network;            // Rede NNUE; vazio = avaliação manual
+};
+
+// coordinator --input ARQ --output ARQ [--mode analyze|selfplay] [--bind ADDR] [--port N]
+//             [--depth D] [--nodes N] [--movetime MS] [--batch N] [--lease-timeout S] [--max-attempts N]
+bool parse_coordinator_options(const std::vector<std::string>& args, CoordinatorOptions& options, std::string& error);
+
+// worker [--connect HOST:PORT] [--threads N] [--hash MB] [--retry S] [--network ARQ]
+bool parse_worker_options(const std::vector<std::string>& args, WorkerOptions& options, std::string& error);
+
+// Roda até todos os itens terem resultado (ou SIGINT/SIGTERM, retomável)
+bool run_coordinator(const CoordinatorOptions& options);
+
+// Roda até o coordenador mandar "finished"; false se não conseguir conectar
+bool run_worker(const WorkerOptions& options);
+
+#endif // DISTRIBUTED_H
@@ -0,0 +1,38 @@
+// Benchmark de throughput da avaliação estática em posições fixas
+// Uso: ./eval_bench [iterações]
+
+#include "chess_engine.h"
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+
+int main(int argc, char* argv[]) {
+    const char* fens[] = {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "r1bq1rk1/pp2bppp/2n1pn2/3p4/2PP4/2N1PN2/PP1B1PPP/R2QKB1R w KQ - 0 8",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1"
+    };
+    int iterations = (argc > 1) ? std::atoi(argv[1]) : 200000;
+
+    ChessEngine engine;
+    std::vector<ChessBoard> boards;
+    for (const char* fen : fens) boards.emplace_back(fen);
+
+    // A soma serve de assinatura: deve ser idêntica entre versões equivalentes
+    long long checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        for (const ChessBoard& board : boards) checksum += engine.static_evaluation(board);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    long long evals = (long long)iterations * boards.size();
+    std::cout << "Avaliações: " << evals << "\n";
+    std::cout << "Tempo: " << seconds << " s\n";
+    std::cout << "Avaliações/s: " << (long long)(evals / seconds) << "\n";
+    std::cout << "Checksum: " << checksum << "\n";
+    return 0;
+}
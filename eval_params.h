@@ -0,0 +1,20 @@
+#ifndef EVAL_PARAMS_H
+#define EVAL_PARAMS_H
+
+// Pesos da avaliação manual além do material/PST (ver pesto.h).
+// Podem ser regenerados pelo texel_tuner (mesmo formato).
+
+// Bônus por casa atacada, por tipo de peça [PAWN..KING] (sem interpolação de fase)
+inline constexpr int MOBILITY_BONUS[6] = { 0, 4, 3, 2, 1, 0 };
+
+// --- ESTRUTURA DE PEÕES ---
+inline constexpr int PASSED_MG[8] = { 0,  5, 10, 15, 30, 50,  80, 0 }; // Por rank relativo
+inline constexpr int PASSED_EG[8] = { 0, 10, 15, 30, 55, 90, 140, 0 };
+inline constexpr int ISOLATED_MG = -10, ISOLATED_EG = -15;
+inline constexpr int DOUBLED_MG  = -10, DOUBLED_EG  = -25;
+inline constexpr int BACKWARD_MG =  -8, BACKWARD_EG = -12;
+
+// Escudo de peões do rei (apenas meio-jogo)
+inline constexpr int SHIELD_NEAR = 12, SHIELD_FAR = 6, SHIELD_MISSING = -10;
+
+#endif // EVAL_PARAMS_H
@@ -0,0 +1,34 @@
+#ifndef GAME_RULES_H
+#define GAME_RULES_H
+
+#include "chess.h"
+
+// Regras de fim de partida compartilhadas pelas ferramentas que jogam partidas
+// inteiras (datagen, match, self-play distribuído).
+
+const char* const START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+// Self-play (datagen e worker distribuído)
+const int MAX_GAME_PLIES = 400;
+const int WIN_ADJUDICATION_SCORE = 2000;    // |score| por 4 plies seguidos -> vitória
+const int WIN_ADJUDICATION_PLIES = 4;
+const int DRAW_ADJUDICATION_PLY = 80;       // Depois do ply 80, |score| <= 10 por 10 plies -> empate
+const int DRAW_ADJUDICATION_SCORE = 10;
+const int DRAW_ADJUDICATION_PLIES = 10;
+
+// K x K, um menor sozinho, ou só bispos da mesma cor de casa
+inline bool insufficient_material(const ChessBoard& board) {
+    int minors = 0, bishop_colors[2] = { 0, 0 };
+    for (Square sq = 0; sq < 64; sq++) {
+        PieceType pt = board.get_piece(sq);
+        if (pt == PAWN || pt == ROOK || pt == QUEEN) return false;
+        if (pt == KNIGHT) minors++;
+        if (pt == BISHOP) {
+            minors++;
+            bishop_colors[(ChessBoard::get_file(sq) + ChessBoard::get_rank(sq)) & 1]++;
+        }
+    }
+    return minors <= 1 || bishop_colors[0] == minors || bishop_colors[1] == minors;
+}
+
+#endif
@@ -0,0 +1,268 @@
+#include "uci_interface.h"
+#include "../bench.h"
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+#include <algorithm>
+
+const char* START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+UCIInterface::UCIInterface() : board(START_FEN), debug_mode(false), move_overhead(30), search_done(true), search_infinite(false), input_closed(false) {
+    // Padrão anunciado em EvalFile: a GUI só manda setoption para valores diferentes
+    engine.load_network(DEFAULT_NETWORK_FILE);
+}
+
+UCIInterface::~UCIInterface() {
+    handle_stop();
+}
+
+void UCIInterface::read_input() {
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        std::vector<std::string> tokens = split(line, ' ');
+        if (tokens.empty()) continue;
+
+        // Efeito imediato sobre a busca; o comando também entra na fila para
+        // valer na ordem (um "go" ainda na fila zeraria o stop dado agora)
+        const std::string& command = tokens[0];
+        if (command == "stop" || command == "quit") engine.stop();
+        else if (command == "ponderhit") engine.ponderhit();
+
+        std::lock_guard<std::mutex> lock(input_mutex);
+        commands.push_back(line);
+        input_cv.notify_one();
+        if (command == "quit") return;
+    }
+    std::lock_guard<std::mutex> lock(input_mutex);
+    input_closed = true;
+    input_cv.notify_one();
+}
+
+bool UCIInterface::next_command(std::string& line) {
+    std::unique_lock<std::mutex> lock(input_mutex);
+    input_cv.wait(lock, [&] { return !commands.empty() || input_closed; });
+    if (commands.empty()) return false;
+    line = std::move(commands.front());
+    commands.pop_front();
+    return true;
+}
+
+void UCIInterface::run() {
+    input_thread = std::thread(&UCIInterface::read_input, this);
+    std::string line;
+    while (next_command(line)) {
+        std::vector<std::string> tokens = split(line, ' ');
+        const std::string& command = tokens[0];
+
+        // Durante a busca só isready, stop, ponderhit e debug são atendidos na hora
+        if (command == "isready") handle_isready();
+        else if (command == "stop") handle_stop();
+        else if (command == "ponderhit") engine.ponderhit();
+        else if (command == "debug") debug_mode = (tokens.size() > 1 && tokens[1] == "on");
+        else if (command == "quit") { handle_stop(); input_thread.join(); return; }
+        else {
+            wait_for_search();
+            if (command == "uci") handle_uci();
+            else if (command == "ucinewgame") handle_ucinewgame();
+            else if (command == "position") handle_position(tokens);
+            else if (command == "go") handle_go(tokens);
+            else if (command == "setoption") handle_setoption(tokens);
+            else if (command == "bench") handle_bench(tokens);
+            else if (command == "d") { board.print_board(); send("Fen: " + board.to_fen() + "\n"); }
+        }
+    }
+    // Fim da entrada (uso em scripts): "go infinite" para como no quit, um ponder
+    // vira busca normal e as demais buscas terminam pelos próprios limites
+    if (search_infinite) engine.stop();
+    else engine.ponderhit();
+    wait_for_search();
+    input_thread.join();
+}
+
+void UCIInterface::handle_uci() {
+    send("id name Striker Chess Engine\n"
+         "id author Enzo\n"
+         "option name Hash type spin default 64 min 1 max 65536\n"
+         "option name Threads type spin default 1 min 1 max 256\n"
+         "option name Move Overhead type spin default 30 min 0 max 5000\n"
+         "option name Ponder type check default false\n"
+         "option name MultiPV type spin default 1 min 1 max 256\n"
+         "option name EvalFile type string default network.nnue\n"
+         "option name BookFile type string default <empty>\n"
+         "option name BookBestMove type check default false\n"
+         "option name SyzygyPath type string default <empty>\n"
+         "option name SyzygyProbeLimit type spin default 7 min 0 max 7\n"
+         "option name SyzygyProbeDepth type spin default 1 min 1 max 100\n"
+         "uciok\n");
+}
+
+void UCIInterface::handle_isready() {
+    send("readyok\n");
+}
+
+void UCIInterface::handle_ucinewgame() {
+    board.from_fen(START_FEN);
+    position_base.clear();
+    engine.new_game();
+    log_debug("New game started");
+}
+
+void UCIInterface::handle_position(const std::vector<std::string>& tokens) {
+    if (tokens.size() < 2) return;
+    log_debug("Position command received");
+
+    size_t i = 1;
+    std::string fen;
+    if (tokens[i] == "startpos") {
+        fen = START_FEN;
+        i++;
+    } else if (tokens[i] == "fen") {
+        for (i = 2; i < tokens.size() && tokens[i] != "moves"; i++) {
+            if (!fen.empty()) fen += " ";
+            fen += tokens[i];
+        }
+    } else {
+        send("info string Invalid position\n");
+        return;
+    }
+    std::string base = (tokens[1] == "startpos") ? "startpos" : fen;
+    std::vector<std::string> moves;
+    if (i < tokens.size() && tokens[i] == "moves") moves.assign(tokens.begin() + i + 1, tokens.end());
+
+    // A GUI repete a partida inteira a cada lance: se a lista só cresceu,
+    // aplica apenas os lances novos sobre o tabuleiro atual
+    bool extends = !position_base.empty() && base == position_base && moves.size() >= position_moves.size() &&
+                   std::equal(position_moves.begin(), position_moves.end(), moves.begin());
+    if (!extends) {
+        board = ChessBoard(fen);
+        position_base = base;
+        position_moves.clear();
+    }
+
+    for (size_t m = position_moves.size(); m < moves.size(); m++) {
+        Move move;
+        if (!parse_move(moves[m], move)) {
+            send("info string Invalid move " + moves[m] + " (fen " + board.to_fen() + ")\n");
+            position_base.clear(); // Tabuleiro parcial: o próximo position refaz do zero
+            return;
+        }
+        board.make_move(move);
+        position_moves.push_back(moves[m]);
+    }
+    log_debug("Position set: " + board.to_fen() + (extends ? " (incremental)" : ""));
+}
+
+void UCIInterface::handle_go(const std::vector<std::string>& tokens) {
+    SearchLimits limits;
+    limits.move_overhead = move_overhead;
+    for (size_t i = 1; i < tokens.size(); i++) {
+        const std::string& key = tokens[i];
+        bool has_value = (i + 1 < tokens.size());
+        if (key == "infinite") limits.infinite = true;
+        else if (key == "ponder") limits.ponder = true;
+        else if (!has_value) continue;
+        else if (key == "wtime") limits.wtime = std::atoi(tokens[++i].c_str());
+        else if (key == "btime") limits.btime = std::atoi(tokens[++i].c_str());
+        else if (key == "winc") limits.winc = std::atoi(tokens[++i].c_str());
+        else if (key == "binc") limits.binc = std::atoi(tokens[++i].c_str());
+        else if (key == "movestogo") limits.movestogo = std::atoi(tokens[++i].c_str());
+        else if (key == "movetime") limits.movetime = std::atoi(tokens[++i].c_str());
+        else if (key == "depth") limits.depth = std::atoi(tokens[++i].c_str());
+        else if (key == "nodes") limits.nodes = std::strtoull(tokens[++i].c_str(), nullptr, 10);
+    }
+
+    log_debug("Searching position: " + board.to_fen());
+    search_infinite = limits.infinite;
+    search_done = false;
+    search_thread = std::thread([this, root = board, limits] {
+        Move best = engine.get_best_move(root, limits);
+        std::string output = "bestmove " + (best.from == NO_SQUARE ? std::string("0000") : best.to_string());
+        // Resposta esperada do oponente (segundo lance da PV), usada no próximo "go ponder"
+        const std::vector<Move>& pv = engine.get_search_stats().pv;
+        if (pv.size() > 1 && pv[0] == best) output += " ponder " + pv[1].to_string();
+        send(output + "\n");
+        search_done = true;
+    });
+    // A busca zera stop/ponderhit ao começar: espera ela começar para que
+    // um "stop" enviado logo após o "go" não se perca
+    while (!engine.is_searching() && !search_done) std::this_thread::yield();
+}
+
+void UCIInterface::handle_stop() {
+    engine.stop();
+    wait_for_search();
+}
+
+void UCIInterface::wait_for_search() {
+    if (search_thread.joinable()) search_thread.join();
+}
+
+// setoption name <nome com espaços> value <valor>
+void UCIInterface::handle_setoption(const std::vector<std::string>& tokens) {
+    std::string name, value;
+    size_t i = 1;
+    if (i < tokens.size() && tokens[i] == "name") i++;
+    for (; i < tokens.size() && tokens[i] != "value"; i++) name += (name.empty() ? "" : " ") + tokens[i];
+    for (i++; i < tokens.size(); i++) value += (value.empty() ? "" : " ") + tokens[i];
+
+    if (name == "Hash") engine.set_hash_size(std::max(1, std::atoi(value.c_str())));
+    else if (name == "Threads") engine.set_threads(std::atoi(value.c_str()));
+    else if (name == "Move Overhead") move_overhead = std::max(0, std::atoi(value.c_str()));
+    else if (name == "MultiPV") engine.set_multi_pv(std::atoi(value.c_str()));
+    else if (name == "EvalFile") {
+        if (value.empty() || value == "<empty>") engine.unload_network();
+        else if (engine.load_network(value)) send("info string NNUE loaded: " + value + "\n");
+        else send("info string Failed to load NNUE: " + value + "\n");
+    }
+    else if (name == "BookFile") {
+        if (value.empty() || value == "<empty>") engine.unload_book();
+        else if (engine.load_book(value)) send("info string Book loaded: " + value + "\n");
+        else send("info string Failed to load book: " + value + "\n");
+    }
+    else if (name == "BookBestMove") engine.set_book_best_move(value == "true");
+    else if (name == "SyzygyPath") {
+        if (!SyzygyTablebases::compiled_in()) send("info string Syzygy support not compiled in (fathom/ missing)\n");
+        else if (SyzygyTablebases::init(value)) send("info string Syzygy tablebases loaded, up to " + std::to_string(SyzygyTablebases::largest()) + " pieces\n");
+        else if (value != "<empty>" && !value.empty()) send("info string No Syzygy tablebases found in " + value + "\n");
+    }
+    else if (name == "SyzygyProbeLimit") engine.set_syzygy_probe_limit(std::atoi(value.c_str()));
+    else if (name == "SyzygyProbeDepth") engine.set_syzygy_probe_depth(std::max(1, std::atoi(value.c_str())));
+}
+
+// bench [profundidade] [threads]
+void UCIInterface::handle_bench(const std::vector<std::string>& tokens) {
+    int depth = (tokens.size() > 1) ? std::atoi(tokens[1].c_str()) : BENCH_DEFAULT_DEPTH;
+    int threads = (tokens.size() > 2) ? std::atoi(tokens[2].c_str()) : 1;
+    run_bench(depth, threads);
+}
+
+bool UCIInterface::parse_move(const std::string& move_str, Move& move) const {
+    if (move_str.size() < 4) return false;
+    Move wanted = Move::from_string(move_str);
+    for (const Move& legal : board.generate_legal_moves()) {
+        if (legal == wanted) { move = legal; return true; }
+    }
+    return false;
+}
+
+std::vector<std::string> UCIInterface::split(const std::string& str, char delimiter) {
+    std::vector<std::string> tokens;
+    std::stringstream ss(str);
+    std::string token;
+    while (std::getline(ss, token, delimiter)) {
+        if (!token.empty()) tokens.push_back(token);
+    }
+    return tokens;
+}
+
+// Com sync_with_stdio, cada << vira uma escrita inteira no stdout: linhas da
+// thread de busca e da de comandos não se misturam
+void UCIInterface::send(const std::string& text) {
+    std::cout << text;
+    std::cout.flush();
+}
+
+void UCIInterface::log_debug(const std::string& message) const {
+    if (debug_mode) send("info string [DEBUG] " + message + "\n");
+}
@@ -0,0 +1,69 @@
+#ifndef UCI_INTERFACE_H
+#define UCI_INTERFACE_H
+
+#include "../chess.h"
+#include "../chess_engine.h"
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+
+// Protocolo UCI sobre stdin/stdout (usado pelo lichess-bot e pelo cutechess)
+class UCIInterface {
+private:
+    ChessBoard board;
+    ChessEngine engine;
+    bool debug_mode;
+    int move_overhead;
+
+    // Último "position" aplicado: um novo que só acrescenta lances reaproveita o tabuleiro
+    std::string position_base; // "startpos" ou a FEN; vazio = refazer do zero
+    std::vector<std::string> position_moves;
+
+    // "go" roda numa thread própria para que stop/ponderhit/isready sejam lidos durante a busca
+    std::thread search_thread;
+    std::atomic<bool> search_done;
+    bool search_infinite; // "go infinite" pendente: só termina com stop
+
+    // stdin é lido numa thread dedicada: stop, ponderhit e quit agem na hora,
+    // mesmo com a thread de comandos esperando a busca terminar
+    std::thread input_thread;
+    std::mutex input_mutex;
+    std::condition_variable input_cv;
+    std::deque<std::string> commands;
+    bool input_closed;
+
+    void handle_uci();
+    void handle_isready();
+    void handle_ucinewgame();
+    void handle_position(const std::vector<std::string>& tokens);
+    void handle_go(const std::vector<std::string>& tokens);
+    void handle_setoption(const std::vector<std::string>& tokens);
+    void handle_bench(const std::vector<std::string>& tokens);
+    void handle_stop();
+
+    // Espera a busca em andamento terminar (comandos que mexem no estado da engine)
+    void wait_for_search();
+
+    void read_input();
+    // Próximo comando na ordem de chegada; false quando a entrada acabou
+    bool next_command(std::string& line);
+
+    // Converte "e2e4" no lance legal correspondente (com flags de roque/en passant)
+    bool parse_move(const std::string& move_str, Move& move) const;
+
+    static std::vector<std::string> split(const std::string& str, char delimiter);
+    // Uma ou mais linhas completas, escritas de uma vez e com um único flush
+    static void send(const std::string& text);
+    void log_debug(const std::string& message) const;
+
+public:
+    UCIInterface();
+    ~UCIInterface();
+    void run();
+};
+
+#endif // UCI_INTERFACE_H
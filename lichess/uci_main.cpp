@@ -0,0 +1,109 @@
+#include "uci_interface.h"
+#include "../bench.h"
+#include "../batch.h"
+#include "../match.h"
+#include "../server.h"
+#include "../shm_server.h"
+#include "../distributed.h"
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <fstream>
+#include <vector>
+
+// Uso:
+//   ./chess_uci                           -> protocolo UCI em stdin/stdout
+//   ./chess_uci bench [profundidade] [threads]
+//   ./chess_uci batch [--threads N] [--depth D] [--nodes N] [--movetime MS]
+//                     [--hash MB] [--network ARQ] [--unordered] [arquivo.epd]   -> NDJSON em stdout
+//   ./chess_uci match --engine name=A [cmd=BIN] [option.X=V ...] --engine name=B ...
+//                     [--games N] [--concurrency N] [--tc 10+0.1] [--openings ARQ]
+//                     [--pgnout ARQ] [--sprt elo0=0 elo1=5] ...   (ver match.h)
+//   ./chess_uci serve [--unix PATH | --port N] [--threads N] [--hash MB]
+//                     [--max-queue N] [--network ARQ]               (ver server.h)
+//   ./chess_uci shm-eval [--name /NOME] [--slots N] [--threads N]   (ver shm_eval.h)
+//   ./chess_uci coordinator --input ARQ --output ARQ [--mode analyze|selfplay] [--port N]
+//                     [--depth D] [--nodes N] [--batch N] [--lease-timeout S] ...  (ver distributed.h)
+//   ./chess_uci worker [--connect HOST:PORT] [--threads N] [--hash MB] [--retry S] [--network ARQ]
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "bench") {
+        int depth = (argc > 2) ? std::atoi(argv[2]) : BENCH_DEFAULT_DEPTH;
+        int threads = (argc > 3) ? std::atoi(argv[3]) : 1;
+        run_bench(depth, threads);
+        return 0;
+    }
+
+    if (argc > 1 && std::string(argv[1]) == "batch") {
+        BatchOptions options;
+        std::string error;
+        if (!parse_batch_options(std::vector<std::string>(argv + 2, argv + argc), options, error)) {
+            std::cerr << "batch: " << error << std::endl;
+            return 1;
+        }
+        if (options.input.empty() || options.input == "-") {
+            run_batch(options, std::cin, std::cout);
+        } else {
+            std::ifstream file(options.input);
+            if (!file) {
+                std::cerr << "batch: cannot open " << options.input << std::endl;
+                return 1;
+            }
+            run_batch(options, file, std::cout);
+        }
+        return 0;
+    }
+
+    if (argc > 1 && std::string(argv[1]) == "match") {
+        MatchOptions options;
+        std::string error;
+        if (!parse_match_options(std::vector<std::string>(argv + 2, argv + argc), options, error)) {
+            std::cerr << "match: " << error << std::endl;
+            return 1;
+        }
+        return run_match(options, std::cout) ? 0 : 1;
+    }
+
+    if (argc > 1 && std::string(argv[1]) == "serve") {
+        ServerOptions options;
+        std::string error;
+        if (!parse_server_options(std::vector<std::string>(argv + 2, argv + argc), options, error)) {
+            std::cerr << "serve: " << error << std::endl;
+            return 1;
+        }
+        return run_server(options) ? 0 : 1;
+    }
+
+    if (argc > 1 && std::string(argv[1]) == "shm-eval") {
+        ShmServerOptions options;
+        std::string error;
+        if (!parse_shm_options(std::vector<std::string>(argv + 2, argv + argc), options, error)) {
+            std::cerr << "shm-eval: " << error << std::endl;
+            return 1;
+        }
+        return run_shm_server(options) ? 0 : 1;
+    }
+
+    if (argc > 1 && std::string(argv[1]) == "coordinator") {
+        CoordinatorOptions options;
+        std::string error;
+        if (!parse_coordinator_options(std::vector<std::string>(argv + 2, argv + argc), options, error)) {
+            std::cerr << "coordinator: " << error << std::endl;
+            return 1;
+        }
+        return run_coordinator(options) ? 0 : 1;
+    }
+
+    if (argc > 1 && std::string(argv[1]) == "worker") {
+        WorkerOptions options;
+        std::string error;
+        if (!parse_worker_options(std::vector<std::string>(argv + 2, argv + argc), options, error)) {
+            std::cerr << "worker: " << error << std::endl;
+            return 1;
+        }
+        return run_worker(options) ? 0 : 1;
+    }
+
+    UCIInterface uci;
+    uci.run();
+    return 0;
+}
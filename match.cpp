@@ -0,0 +1,1022 @@
+#include "match.h"
+#include "batch.h"
+#include "chess_engine.h"
+#include "syzygy.h"
+#include "game_rules.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cctype>
+#include <ctime>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <cerrno>
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const int MATE_SCORE_CP = 30000;          // Mate normalizado para a adjudicação
+const int HANDSHAKE_TIMEOUT_MS = 10000;   // uciok / readyok
+const size_t IN_PROCESS_HASH_MB = 16;     // TT padrão por engine em processo
+const double Z_95 = 1.959964;
+
+int64_t elapsed_ms(Clock::time_point since) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - since).count();
+}
+
+std::vector<std::string> split_words(const std::string& line) {
+    std::istringstream ss(line);
+    std::vector<std::string> words;
+    std::string word;
+    while (ss >> word) words.push_back(word);
+    return words;
+}
+
+// ========================================
+// SAN (aberturas PGN e PGN de saída)
+// ========================================
+
+// Sem sufixo de xeque/mate
+std::string san_base(const ChessBoard& board, const Move& move, const std::vector<Move>& legal) {
+    if (move.is_castle) return (ChessBoard::get_file(move.to) > ChessBoard::get_file(move.from)) ? "O-O" : "O-O-O";
+
+    PieceType pt = board.get_piece(move.from);
+    bool capture = move.is_en_passant || board.get_piece(move.to) != NONE;
+    std::string san;
+    if (pt == PAWN) {
+        if (capture) san += (char)('a' + ChessBoard::get_file(move.from));
+    } else {
+        san += "PNBRQK"[pt];
+        bool ambiguous = false, same_file = false, same_rank = false;
+        for (const Move& other : legal) {
+            if (other.to != move.to || other.from == move.from || board.get_piece(other.from) != pt) continue;
+            ambiguous = true;
+            if (ChessBoard::get_file(other.from) == ChessBoard::get_file(move.from)) same_file = true;
+            if (ChessBoard::get_rank(other.from) == ChessBoard::get_rank(move.from)) same_rank = true;
+        }
+        if (ambiguous) {
+            std::string from = ChessBoard::square_to_string(move.from);
+            if (!same_file) san += from[0];
+            else if (!same_rank) san += from[1];
+            else san += from;
+        }
+    }
+    if (capture) san += 'x';
+    san += ChessBoard::square_to_string(move.to);
+    if (move.promotion != NONE) {
+        san += '=';
+        san += "PNBRQK"[move.promotion];
+    }
+    return san;
+}
+
+std::string to_san(const ChessBoard& board, const Move& move, const std::vector<Move>& legal) {
+    std::string san = san_base(board, move, legal);
+    ChessBoard after = board;
+    after.make_move(move);
+    if (after.is_check(after.get_side_to_move())) san += after.generate_legal_moves().empty() ? '#' : '+';
+    return san;
+}
+
+// "Nf3+", "e8Q", "0-0" -> lance legal (false se não houver)
+bool parse_san(const ChessBoard& board, std::string token, Move& move) {
+    while (!token.empty() && std::string("+#!?").find(token.back()) != std::string::npos) token.pop_back();
+    token.erase(std::remove(token.begin(), token.end(), '='), token.end());
+    std::replace(token.begin(), token.end(), '0', 'O');
+
+    std::vector<Move> legal = board.generate_legal_moves();
+    for (const Move& candidate : legal) {
+        std::string san = san_base(board, candidate, legal);
+        san.erase(std::remove(san.begin(), san.end(), '='), san.end());
+        if (san == token) { move = candidate; return true; }
+    }
+    return false;
+}
+
+// ========================================
+// Aberturas
+// ========================================
+
+struct Opening {
+    std::string fen;
+    std::vector<Move> moves;
+};
+
+// Só os quatro primeiros campos da EPD; relógios começam do zero. A posição
+// precisa ser válida (batch.h) e ter lances
+bool parse_epd_opening(const std::string& line, Opening& opening) {
+    std::string fen, id;
+    if (!parse_epd(line, fen, id)) return false;
+    std::vector<std::string> fields = split_words(fen);
+    opening.fen = fields[0] + " " + fields[1] + " " + fields[2] + " " + fields[3] + " 0 1";
+    ChessBoard board(opening.fen);
+    return valid_position(board) && !board.generate_legal_moves().empty();
+}
+
+// opening.fen vem do cabeçalho [FEN] (ou START_FEN) e passa pelo mesmo parser
+bool parse_pgn_moves(const std::string& text, int max_plies, Opening& opening) {
+    std::string fen, id;
+    if (!parse_epd(opening.fen, fen, id)) return false;
+    opening.fen = fen;
+    ChessBoard board(opening.fen);
+    if (!valid_position(board)) return false;
+
+    size_t i = 0;
+    int variation = 0;
+    while (i < text.size()) {
+        char c = text[i];
+        if (c == '{') { i = text.find('}', i); if (i == std::string::npos) break; i++; continue; }
+        if (c == ';') { i = text.find('\n', i); if (i == std::string::npos) break; continue; }
+        if (c == '(') { variation++; i++; continue; }
+        if (c == ')') { variation--; i++; continue; }
+        if (std::isspace((unsigned char)c) || variation > 0) { i++; continue; }
+
+        size_t end = i;
+        while (end < text.size() && !std::isspace((unsigned char)text[end]) && std::string("{}();").find(text[end]) == std::string::npos) end++;
+        std::string token = text.substr(i, end - i);
+        i = end;
+
+        // "12." / "12..." / "12...Nf6"
+        size_t digits = 0;
+        while (digits < token.size() && std::isdigit((unsigned char)token[digits])) digits++;
+        if (digits > 0 && digits < token.size() && token[digits] == '.') {
+            token.erase(0, token.find_first_not_of('.', digits));
+            if (token.find_first_not_of('.') == std::string::npos) continue;
+        }
+        if (token.empty() || token[0] == '$') continue;
+        if (token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*") break;
+        if (max_plies > 0 && (int)opening.moves.size() >= max_plies) break;
+
+        Move move;
+        if (!parse_san(board, token, move)) return false;
+        board.make_move(move);
+        opening.moves.push_back(move);
+    }
+    return !board.generate_legal_moves().empty(); // Lances legais preservam valid_position
+}
+
+bool load_openings(const std::string& path, int max_plies, std::vector<Opening>& openings, std::string& error) {
+    if (path.empty()) {
+        openings.push_back({ START_FEN, {} });
+        return true;
+    }
+    std::ifstream file(path);
+    if (!file) { error = "cannot open " + path; return false; }
+
+    std::string lower = path;
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    bool pgn = lower.size() > 4 && lower.compare(lower.size() - 4, 4, ".pgn") == 0;
+
+    size_t invalid = 0;
+    std::string line;
+    if (!pgn) {
+        while (std::getline(file, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.find_first_not_of(" \t") == std::string::npos || line[0] == '#') continue;
+            Opening opening;
+            if (parse_epd_opening(line, opening)) openings.push_back(opening);
+            else invalid++;
+        }
+    } else {
+        std::string fen, text;
+        auto flush = [&]() {
+            if (text.find_first_not_of(" \t\n") == std::string::npos && fen.empty()) return;
+            Opening opening;
+            opening.fen = fen.empty() ? START_FEN : fen;
+            if (parse_pgn_moves(text, max_plies, opening)) openings.push_back(opening);
+            else invalid++;
+            fen.clear();
+            text.clear();
+        };
+        bool in_moves = false;
+        while (std::getline(file, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            size_t start = line.find_first_not_of(" \t");
+            if (start != std::string::npos && line[start] == '[') {
+                if (in_moves) { flush(); in_moves = false; }
+                size_t open = line.find('"'), close = line.rfind('"');
+                if (line.compare(start, 5, "[FEN ") == 0 && open != std::string::npos && close > open) {
+                    fen = line.substr(open + 1, close - open - 1);
+                }
+                continue;
+            }
+            if (start != std::string::npos) in_moves = true;
+            text += line + "\n";
+        }
+        flush();
+    }
+
+    if (invalid) std::cerr << "match: skipped " << invalid << " invalid opening(s) in " << path << std::endl;
+    if (openings.empty()) { error = "no usable openings in " + path; return false; }
+    return true;
+}
+
+// ========================================
+// Jogadores: ChessEngine em processo ou binário UCI
+// ========================================
+
+struct PlayerMove {
+    Move move;
+    std::string text;      // Lance como veio da engine (para mensagens)
+    bool has_score = false;
+    int score = 0;         // cp, ponto de vista de quem joga
+    int mate = 0;          // != 0: mate em N (sinal = quem vence)
+    int depth = 0;
+    bool timed_out = false;
+    std::string error;     // Engine caiu / não respondeu
+};
+
+class Player {
+public:
+    virtual ~Player() = default;
+    virtual bool new_game(std::string& error) = 0;
+    // timeout_ms < 0: espera sem limite
+    virtual PlayerMove go(const ChessBoard& board, const std::string& start_fen,
+                          const std::vector<Move>& moves, const SearchLimits& limits, int timeout_ms) = 0;
+};
+
+class InProcessPlayer : public Player {
+private:
+    ChessEngine engine;
+    int move_overhead = SearchLimits().move_overhead;
+
+public:
+    bool configure(const MatchEngine& spec, std::string& error) {
+        engine.set_silent(true);
+        engine.set_hash_size(IN_PROCESS_HASH_MB);
+        for (const auto& option : spec.options) {
+            const std::string& name = option.first;
+            const std::string& value = option.second;
+            bool empty = value.empty() || value == "<empty>";
+            if (name == "Hash") engine.set_hash_size(std::max(1, std::atoi(value.c_str())));
+            else if (name == "Move Overhead") move_overhead = std::max(0, std::atoi(value.c_str()));
+            else if (name == "MultiPV") engine.set_multi_pv(std::atoi(value.c_str()));
+            else if (name == "EvalFile") {
+                if (empty) engine.unload_network();
+                else if (!engine.load_network(value)) { error = "cannot load network " + value; return false; }
+            }
+            else if (name == "BookFile") {
+                if (empty) engine.unload_book();
+                else if (!engine.load_book(value)) { error = "cannot load book " + value; return false; }
+            }
+            else if (name == "BookBestMove") engine.set_book_best_move(value == "true");
+            else if (name == "SyzygyPath") {} // Globais: iniciadas uma vez em run_match, antes dos workers
+            else if (name == "SyzygyProbeLimit") engine.set_syzygy_probe_limit(std::atoi(value.c_str()));
+            else if (name == "SyzygyProbeDepth") engine.set_syzygy_probe_depth(std::max(1, std::atoi(value.c_str())));
+            else { error = "unknown option " + name; return false; }
+        }
+        return true;
+    }
+
+    bool new_game(std::string&) override {
+        engine.new_game();
+        return true;
+    }
+
+    PlayerMove go(const ChessBoard& board, const std::string&, const std::vector<Move>&,
+                  const SearchLimits& limits, int) override {
+        SearchLimits own = limits;
+        own.move_overhead = move_overhead;
+        PlayerMove result;
+        result.move = engine.get_best_move(board, own);
+        result.text = result.move.to_string();
+        const SearchStats& stats = engine.get_search_stats();
+        if (stats.depth > 0) { // 0 = lance do livro
+            result.has_score = true;
+            result.score = ChessEngine::score_to_cp(stats.score);
+            result.mate = ChessEngine::mate_in(stats.score);
+            result.depth = stats.depth;
+        }
+        return result;
+    }
+};
+
+#ifndef _WIN32
+// fork entre pipe() e FD_CLOEXEC vazaria os pipes de uma engine para outra
+std::mutex spawn_mutex;
+#endif
+
+class UciPlayer : public Player {
+private:
+    MatchEngine spec;
+    bool running = false;
+#ifndef _WIN32
+    pid_t pid = -1;
+    int to_engine = -1;
+    int from_engine = -1;
+    std::string buffer;
+#endif
+
+    bool send(const std::string& line) {
+#ifndef _WIN32
+        std::string data = line + "\n";
+        size_t written = 0;
+        while (written < data.size()) {
+            ssize_t n = write(to_engine, data.data() + written, data.size() - written);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            written += (size_t)n;
+        }
+        return true;
+#else
+        (void)line;
+        return false;
+#endif
+    }
+
+    // false em timeout ou fim do processo
+    bool read_line(std::string& line, Clock::time_point deadline, bool unlimited) {
+#ifndef _WIN32
+        while (true) {
+            size_t newline = buffer.find('\n');
+            if (newline != std::string::npos) {
+                line = buffer.substr(0, newline);
+                buffer.erase(0, newline + 1);
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                return true;
+            }
+            int wait = -1;
+            if (!unlimited) {
+                auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+                wait = (int)std::max<int64_t>(0, left);
+            }
+            pollfd fd = { from_engine, POLLIN, 0 };
+            int ready = poll(&fd, 1, wait);
+            if (ready < 0 && errno == EINTR) continue;
+            if (ready <= 0) return false;
+            char chunk[4096];
+            ssize_t n = read(from_engine, chunk, sizeof(chunk));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            buffer.append(chunk, (size_t)n);
+        }
+#else
+        (void)line; (void)deadline; (void)unlimited;
+        return false;
+#endif
+    }
+
+    bool wait_for(const std::string& token, int timeout_ms) {
+        auto deadline = Clock::now() + std::chrono::milliseconds(timeout_ms);
+        std::string line;
+        while (read_line(line, deadline, false)) {
+            if (line == token || line.rfind(token + " ", 0) == 0) return true;
+        }
+        return false;
+    }
+
+    bool start(std::string& error) {
+#ifndef _WIN32
+        {
+            std::lock_guard<std::mutex> lock(spawn_mutex);
+            int in_pipe[2], out_pipe[2];
+            if (pipe(in_pipe) != 0) { error = "pipe failed"; return false; }
+            if (pipe(out_pipe) != 0) { close(in_pipe[0]); close(in_pipe[1]); error = "pipe failed"; return false; }
+            for (int fd : { in_pipe[0], in_pipe[1], out_pipe[0], out_pipe[1] }) fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+            pid = fork();
+            if (pid == 0) {
+                dup2(in_pipe[0], STDIN_FILENO);
+                dup2(out_pipe[1], STDOUT_FILENO);
+                std::string command = "exec " + spec.command;
+                execl("/bin/sh", "sh", "-c", command.c_str(), (char*)nullptr);
+                _exit(127);
+            }
+            close(in_pipe[0]);
+            close(out_pipe[1]);
+            if (pid < 0) { close(in_pipe[1]); close(out_pipe[0]); error = "fork failed"; return false; }
+            to_engine = in_pipe[1];
+            from_engine = out_pipe[0];
+            buffer.clear();
+            running = true;
+        }
+
+        if (!send("uci") || !wait_for("uciok", HANDSHAKE_TIMEOUT_MS)) {
+            error = "'" + spec.command + "' did not answer uciok";
+            shutdown();
+            return false;
+        }
+        for (const auto& option : spec.options) send("setoption name " + option.first + " value " + option.second);
+        if (!send("isready") || !wait_for("readyok", HANDSHAKE_TIMEOUT_MS)) {
+            error = "'" + spec.command + "' did not answer readyok";
+            shutdown();
+            return false;
+        }
+        return true;
+#else
+        error = "UCI binaries (cmd=) are not supported on Windows builds; use the in-process engine";
+        return false;
+#endif
+    }
+
+    void shutdown() {
+#ifndef _WIN32
+        if (!running) return;
+        send("quit");
+        close(to_engine);
+        // Meio segundo para sair sozinha, depois SIGKILL
+        int status = 0;
+        bool exited = false;
+        for (int i = 0; i < 50 && !exited; i++) {
+            exited = (waitpid(pid, &status, WNOHANG) == pid);
+            if (!exited) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        if (!exited) {
+            kill(pid, SIGKILL);
+            waitpid(pid, &status, 0);
+        }
+        close(from_engine);
+        running = false;
+#endif
+    }
+
+public:
+    explicit UciPlayer(const MatchEngine& engine_spec) : spec(engine_spec) {}
+    ~UciPlayer() override { shutdown(); }
+
+    bool new_game(std::string& error) override {
+        // Engine que travou ou estourou o tempo na partida anterior é reiniciada
+        if (!running && !start(error)) return false;
+        if (!send("ucinewgame") || !send("isready") || !wait_for("readyok", HANDSHAKE_TIMEOUT_MS)) {
+            shutdown();
+            if (!start(error)) return false;
+        }
+        return true;
+    }
+
+    PlayerMove go(const ChessBoard& board, const std::string& start_fen, const std::vector<Move>& moves,
+                  const SearchLimits& limits, int timeout_ms) override {
+        PlayerMove result;
+        std::ostringstream position;
+        position << "position " << (start_fen == START_FEN ? "startpos" : "fen " + start_fen);
+        if (!moves.empty()) position << " moves";
+        for (const Move& m : moves) position << " " << m.to_string();
+
+        std::ostringstream go;
+        go << "go";
+        if (limits.wtime >= 0) go << " wtime " << limits.wtime << " btime " << limits.btime
+                                  << " winc " << limits.winc << " binc " << limits.binc;
+        if (limits.movestogo > 0) go << " movestogo " << limits.movestogo;
+        if (limits.movetime >= 0) go << " movetime " << limits.movetime;
+        if (limits.depth > 0) go << " depth " << limits.depth;
+        if (limits.nodes > 0) go << " nodes " << limits.nodes;
+
+        if (!send(position.str()) || !send(go.str())) {
+            result.error = "disconnects";
+            shutdown();
+            return result;
+        }
+
+        auto deadline = Clock::now() + std::chrono::milliseconds(std::max(0, timeout_ms));
+        std::string line;
+        while (true) {
+            if (!read_line(line, deadline, timeout_ms < 0)) {
+                result.timed_out = (timeout_ms >= 0 && Clock::now() >= deadline);
+                result.error = result.timed_out ? "timeout" : "disconnects";
+                shutdown();
+                return result;
+            }
+            std::vector<std::string> words = split_words(line);
+            if (words.empty()) continue;
+            if (words[0] == "bestmove") {
+                result.text = (words.size() > 1) ? words[1] : "";
+                Move wanted = Move::from_string(result.text);
+                result.move = Move();
+                for (const Move& legal : board.generate_legal_moves()) {
+                    if (legal == wanted) { result.move = legal; break; }
+                }
+                return result;
+            }
+            if (words[0] != "info") continue;
+
+            bool main_line = true, has_score = false;
+            int depth = 0, score = 0, mate = 0;
+            for (size_t i = 1; i + 1 < words.size(); i++) {
+                if (words[i] == "multipv") main_line = (words[i + 1] == "1");
+                else if (words[i] == "depth") depth = std::atoi(words[i + 1].c_str());
+                else if (words[i] == "score" && i + 2 < words.size()) {
+                    has_score = true;
+                    if (words[i + 1] == "mate") {
+                        mate = std::atoi(words[i + 2].c_str());
+                        score = (mate > 0) ? MATE_SCORE_CP : -MATE_SCORE_CP;
+                    } else {
+                        score = std::atoi(words[i + 2].c_str());
+                    }
+                }
+            }
+            if (main_line && has_score) {
+                result.has_score = true;
+                result.score = score;
+                result.mate = mate;
+                result.depth = depth;
+            }
+        }
+    }
+};
+
+std::unique_ptr<Player> make_player(const MatchEngine& spec, std::string& error) {
+    if (spec.command.empty()) {
+        auto player = std::make_unique<InProcessPlayer>();
+        if (!player->configure(spec, error)) return nullptr;
+        return player;
+    }
+    // O processo só é iniciado no primeiro new_game
+    return std::make_unique<UciPlayer>(spec);
+}
+
+// ========================================
+// Partida
+// ========================================
+
+struct GameRecord {
+    std::string start_fen;
+    int first_fullmove = 1;
+    Color first_side = WHITE;
+    std::vector<std::string> san;
+    std::vector<std::string> comments;
+    std::string result = "*";       // Ponto de vista das brancas
+    std::string reason;
+    std::string termination = "normal";
+    std::string error;              // Engine não iniciou: partida não conta
+};
+
+std::string score_comment(const PlayerMove& move, int64_t time_ms) {
+    std::ostringstream ss;
+    if (move.has_score) {
+        if (move.mate) ss << (move.mate > 0 ? "+M" : "-M") << std::abs(move.mate);
+        else ss << (move.score >= 0 ? "+" : "-") << std::fixed << std::setprecision(2) << std::abs(move.score) / 100.0;
+        ss << "/" << move.depth << " ";
+    }
+    ss << std::fixed << std::setprecision(3) << time_ms / 1000.0 << "s";
+    return ss.str();
+}
+
+void play_game(Player* players[2], const Opening& opening, const MatchOptions& options, GameRecord& record) {
+    static const char* const COLOR_NAMES[2] = { "White", "Black" };
+
+    for (int c = 0; c < 2; c++) {
+        if (!players[c]->new_game(record.error)) return;
+    }
+
+    ChessBoard board(opening.fen);
+    record.start_fen = opening.fen;
+    record.first_fullmove = board.get_fullmove_number();
+    record.first_side = board.get_side_to_move();
+
+    std::vector<Move> moves;
+    std::vector<uint64_t> hashes = { board.get_hash() };
+    for (const Move& move : opening.moves) {
+        record.san.push_back(to_san(board, move, board.generate_legal_moves()));
+        record.comments.push_back("book");
+        board.make_move(move);
+        moves.push_back(move);
+        hashes.push_back(board.get_hash());
+    }
+
+    int clock[2] = { options.base_ms, options.base_ms };
+    int moves_made[2] = { 0, 0 };
+    int draw_plies = 0, resign_moves[2] = { 0, 0 };
+    std::string adjudication; // Resultado decidido pelos scores (vale após as regras)
+    std::string adjudication_reason;
+
+    auto finish = [&](const std::string& result, const std::string& reason, const char* termination) {
+        record.result = result;
+        record.reason = reason;
+        record.termination = termination;
+    };
+
+    while (true) {
+        Color us = board.get_side_to_move();
+        Color them = (us == WHITE) ? BLACK : WHITE;
+        const char* loss = (us == WHITE) ? "0-1" : "1-0";
+
+        std::vector<Move> legal = board.generate_legal_moves();
+        if (legal.empty()) {
+            if (board.is_check(us)) finish(loss, std::string(COLOR_NAMES[them]) + " mates", "normal");
+            else finish("1/2-1/2", "Draw by stalemate", "normal");
+            return;
+        }
+        if (board.get_halfmove_clock() >= 100) { finish("1/2-1/2", "Draw by fifty moves rule", "normal"); return; }
+        if (std::count(hashes.begin(), hashes.end(), board.get_hash()) >= 3) { finish("1/2-1/2", "Draw by 3-fold repetition", "normal"); return; }
+        if (insufficient_material(board)) { finish("1/2-1/2", "Draw by insufficient mating material", "normal"); return; }
+        if (!adjudication.empty()) { finish(adjudication, adjudication_reason, "adjudication"); return; }
+
+        SearchLimits limits;
+        int timeout_ms = -1;
+        if (options.base_ms >= 0) {
+            limits.wtime = clock[WHITE];
+            limits.btime = clock[BLACK];
+            limits.winc = limits.binc = options.inc_ms;
+            if (options.tc_moves > 0) limits.movestogo = options.tc_moves - moves_made[us] % options.tc_moves;
+            timeout_ms = clock[us] + options.time_margin;
+        }
+        if (options.movetime >= 0) {
+            limits.movetime = options.movetime;
+            if (timeout_ms < 0) timeout_ms = options.movetime + options.time_margin;
+        }
+        limits.depth = options.depth;
+        limits.nodes = options.nodes;
+
+        auto start = Clock::now();
+        PlayerMove played = players[us]->go(board, opening.fen, moves, limits, timeout_ms);
+        int64_t spent = elapsed_ms(start);
+
+        if (played.timed_out || (timeout_ms >= 0 && spent > timeout_ms)) {
+            finish(loss, std::string(COLOR_NAMES[us]) + " loses on time", "time forfeit");
+            return;
+        }
+        if (!played.error.empty()) {
+            finish(loss, std::string(COLOR_NAMES[us]) + " " + played.error, "rules infraction");
+            return;
+        }
+        if (played.move.from == NO_SQUARE) {
+            finish(loss, std::string(COLOR_NAMES[us]) + " makes an illegal move: " + played.text, "rules infraction");
+            return;
+        }
+        if (options.base_ms >= 0) {
+            clock[us] += options.inc_ms - (int)spent;
+            if (options.tc_moves > 0 && (moves_made[us] + 1) % options.tc_moves == 0) clock[us] += options.base_ms;
+        }
+        moves_made[us]++;
+
+        // Adjudicação pelo score de quem acabou de jogar
+        if (played.has_score) {
+            int score = played.mate ? (played.mate > 0 ? MATE_SCORE_CP : -MATE_SCORE_CP) : played.score;
+            if (options.resign_movecount > 0) {
+                resign_moves[us] = (score <= -options.resign_score) ? resign_moves[us] + 1 : 0;
+                if (resign_moves[us] >= options.resign_movecount && adjudication.empty()) {
+                    adjudication = loss;
+                    adjudication_reason = std::string(COLOR_NAMES[them]) + " wins by adjudication";
+                }
+            }
+            if (options.draw_movecount > 0) {
+                bool quiet = board.get_fullmove_number() >= options.draw_movenumber && std::abs(score) <= options.draw_score;
+                draw_plies = quiet ? draw_plies + 1 : 0;
+                if (draw_plies >= 2 * options.draw_movecount && adjudication.empty()) {
+                    adjudication = "1/2-1/2";
+                    adjudication_reason = "Draw by adjudication";
+                }
+            }
+        } else {
+            resign_moves[us] = 0;
+            draw_plies = 0;
+        }
+
+        record.san.push_back(to_san(board, played.move, legal));
+        record.comments.push_back(score_comment(played, spent));
+        board.make_move(played.move);
+        moves.push_back(played.move);
+        hashes.push_back(board.get_hash());
+    }
+}
+
+std::string time_control_tag(const MatchOptions& options) {
+    if (options.base_ms < 0) return "-"; // Tempo fixo por lance / profundidade / nós
+    std::ostringstream ss;
+    if (options.tc_moves > 0) ss << options.tc_moves << "/";
+    ss << options.base_ms / 1000.0;
+    if (options.inc_ms > 0) ss << "+" << options.inc_ms / 1000.0;
+    return ss.str();
+}
+
+void write_pgn(std::ostream& pgn, const GameRecord& record, const std::string& white, const std::string& black,
+               int round, const std::string& date, const MatchOptions& options) {
+    pgn << "[Event \"chess_uci match\"]\n"
+        << "[Site \"?\"]\n"
+        << "[Date \"" << date << "\"]\n"
+        << "[Round \"" << round << "\"]\n"
+        << "[White \"" << white << "\"]\n"
+        << "[Black \"" << black << "\"]\n"
+        << "[Result \"" << record.result << "\"]\n";
+    if (record.start_fen != START_FEN) pgn << "[FEN \"" << record.start_fen << "\"]\n[SetUp \"1\"]\n";
+    pgn << "[TimeControl \"" << time_control_tag(options) << "\"]\n"
+        << "[PlyCount \"" << record.san.size() << "\"]\n"
+        << "[Termination \"" << record.termination << "\"]\n\n";
+
+    std::string text, line;
+    auto emit = [&](const std::string& token) {
+        if (!line.empty() && line.size() + 1 + token.size() > 80) { text += line + "\n"; line.clear(); }
+        line += (line.empty() ? "" : " ") + token;
+    };
+    int fullmove = record.first_fullmove;
+    Color side = record.first_side;
+    for (size_t i = 0; i < record.san.size(); i++) {
+        if (side == WHITE) emit(std::to_string(fullmove) + ".");
+        else if (i == 0) emit(std::to_string(fullmove) + "...");
+        emit(record.san[i]);
+        emit("{" + record.comments[i] + "}");
+        if (side == BLACK) fullmove++;
+        side = (side == WHITE) ? BLACK : WHITE;
+    }
+    if (!record.reason.empty()) emit("{" + record.reason + "}");
+    emit(record.result);
+    pgn << text << line << "\n\n";
+    pgn.flush();
+}
+
+// ========================================
+// Estatística (ponto de vista da primeira engine)
+// ========================================
+
+struct MatchScore {
+    int wins = 0, losses = 0, draws = 0;
+    int games() const { return wins + losses + draws; }
+    double mean() const { return games() ? (wins + 0.5 * draws) / games() : 0.5; }
+    // Variância por partida do resultado (0, 0.5, 1)
+    double variance() const {
+        if (!games()) return 0;
+        double m = mean();
+        return (wins * (1 - m) * (1 - m) + losses * m * m + draws * (0.5 - m) * (0.5 - m)) / games();
+    }
+};
+
+double elo_from_score(double score) {
+    if (score <= 0) return -INFINITY;
+    if (score >= 1) return INFINITY;
+    return -400.0 * std::log10(1.0 / score - 1.0);
+}
+
+double score_from_elo(double elo) {
+    return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+}
+
+// Aproximação normal do GSPRT (trinomial), Elo logístico
+double sprt_llr(const MatchScore& score, double elo0, double elo1) {
+    double var = score.variance();
+    if (score.games() == 0 || var <= 0) return 0;
+    double s0 = score_from_elo(elo0), s1 = score_from_elo(elo1);
+    return score.games() * (s1 - s0) * (2 * score.mean() - s0 - s1) / (2 * var);
+}
+
+void print_score(std::ostream& out, const MatchScore& score, const MatchOptions& options) {
+    out << "Score of " << options.engines[0].name << " vs " << options.engines[1].name << ": "
+        << score.wins << " - " << score.losses << " - " << score.draws
+        << "  [" << std::fixed << std::setprecision(3) << score.mean() << "] " << score.games() << "\n";
+}
+
+void print_elo(std::ostream& out, const MatchScore& score) {
+    double m = score.mean();
+    double stdev = std::sqrt(score.variance() / std::max(1, score.games()));
+    double elo = elo_from_score(m);
+    double error = (elo_from_score(m + Z_95 * stdev) - elo_from_score(m - Z_95 * stdev)) / 2;
+    int decisive = score.wins + score.losses;
+    double los = decisive ? 0.5 * (1 + std::erf((score.wins - score.losses) / std::sqrt(2.0 * decisive))) : 0.5;
+    out << std::fixed << std::setprecision(1) << "Elo difference: ";
+    if (std::isfinite(elo) && std::isfinite(error)) out << elo + 0.0 << " +/- " << error; // + 0.0: sem "-0.0"
+    else out << (elo > 0 ? "+inf" : "-inf");
+    out << ", LOS: " << los * 100 << " %"
+        << ", DrawRatio: " << 100.0 * score.draws / std::max(1, score.games()) << " %\n";
+}
+
+void print_sprt(std::ostream& out, const MatchOptions& options, double llr, double lower, double upper) {
+    out << std::fixed << std::setprecision(2)
+        << "SPRT: llr " << llr << " (" << std::setprecision(1) << 100 * llr / upper << "%)"
+        << std::setprecision(2) << ", lbound " << lower << ", ubound " << upper
+        << " [" << options.elo0 << ", " << options.elo1 << "]";
+    if (llr >= upper) out << " - H1 was accepted";
+    else if (llr <= lower) out << " - H0 was accepted";
+    out << "\n";
+}
+
+// "k=v" -> par; false sem '='
+bool split_pair(const std::string& token, std::string& key, std::string& value) {
+    size_t eq = token.find('=');
+    if (eq == std::string::npos) return false;
+    key = token.substr(0, eq);
+    value = token.substr(eq + 1);
+    return true;
+}
+
+// "[moves/]seconds[+increment]"
+bool parse_time_control(const std::string& text, MatchOptions& options) {
+    std::string rest = text;
+    size_t slash = rest.find('/');
+    if (slash != std::string::npos) {
+        options.tc_moves = std::atoi(rest.substr(0, slash).c_str());
+        if (options.tc_moves <= 0) return false;
+        rest = rest.substr(slash + 1);
+    }
+    size_t plus = rest.find('+');
+    char* end = nullptr;
+    double base = std::strtod(rest.substr(0, plus).c_str(), &end);
+    if (base <= 0 || *end) return false;
+    options.base_ms = (int)std::lround(base * 1000);
+    if (plus != std::string::npos) {
+        double inc = std::strtod(rest.substr(plus + 1).c_str(), &end);
+        if (inc < 0 || *end) return false;
+        options.inc_ms = (int)std::lround(inc * 1000);
+    }
+    return true;
+}
+
+} // namespace
+
+bool parse_match_options(const std::vector<std::string>& args, MatchOptions& options, std::string& error) {
+    int engine_count = 0;
+    bool has_limit = false;
+    for (size_t i = 0; i < args.size(); i++) {
+        const std::string& arg = args[i];
+
+        // Opções seguidas de pares chave=valor
+        if (arg == "--engine" || arg == "--sprt" || arg == "--draw" || arg == "--resign") {
+            if (arg == "--engine" && engine_count == 2) { error = "more than two --engine"; return false; }
+            MatchEngine* engine = (arg == "--engine") ? &options.engines[engine_count++] : nullptr;
+            if (arg == "--sprt") options.sprt = true;
+            for (; i + 1 < args.size() && args[i + 1].rfind("--", 0) != 0; i++) {
+                std::string key, value;
+                if (!split_pair(args[i + 1], key, value)) { error = "expected key=value after " + arg + ": " + args[i + 1]; return false; }
+                if (engine) {
+                    if (key == "name") engine->name = value;
+                    else if (key == "cmd") engine->command = value;
+                    else if (key.rfind("option.", 0) == 0) engine->options.push_back({ key.substr(7), value });
+                    else { error = "unknown engine setting " + key; return false; }
+                }
+                else if (arg == "--sprt" && key == "elo0") options.elo0 = std::atof(value.c_str());
+                else if (arg == "--sprt" && key == "elo1") options.elo1 = std::atof(value.c_str());
+                else if (arg == "--sprt" && key == "alpha") options.alpha = std::atof(value.c_str());
+                else if (arg == "--sprt" && key == "beta") options.beta = std::atof(value.c_str());
+                else if (arg == "--draw" && key == "movenumber") options.draw_movenumber = std::atoi(value.c_str());
+                else if (arg == "--draw" && key == "movecount") options.draw_movecount = std::atoi(value.c_str());
+                else if (arg == "--draw" && key == "score") options.draw_score = std::atoi(value.c_str());
+                else if (arg == "--resign" && key == "movecount") options.resign_movecount = std::atoi(value.c_str());
+                else if (arg == "--resign" && key == "score") options.resign_score = std::atoi(value.c_str());
+                else { error = "unknown setting " + key + " for " + arg; return false; }
+            }
+            continue;
+        }
+
+        if (i + 1 >= args.size()) { error = (arg.rfind("--", 0) == 0) ? "missing value for " + arg : "unexpected argument " + arg; return false; }
+        const std::string& value = args[++i];
+        if (arg == "--games") options.games = std::max(1, std::atoi(value.c_str()));
+        else if (arg == "--concurrency") options.concurrency = std::max(0, std::atoi(value.c_str()));
+        else if (arg == "--tc") {
+            if (!parse_time_control(value, options)) { error = "invalid time control " + value; return false; }
+            has_limit = true;
+        }
+        else if (arg == "--movetime") { options.movetime = std::max(1, std::atoi(value.c_str())); has_limit = true; }
+        else if (arg == "--depth") { options.depth = std::max(1, std::atoi(value.c_str())); has_limit = true; }
+        else if (arg == "--nodes") { options.nodes = std::strtoull(value.c_str(), nullptr, 10); has_limit = options.nodes > 0; }
+        else if (arg == "--timemargin") options.time_margin = std::max(0, std::atoi(value.c_str()));
+        else if (arg == "--openings") options.openings = value;
+        else if (arg == "--plies") options.opening_plies = std::max(0, std::atoi(value.c_str()));
+        else if (arg == "--pgnout") options.pgn_out = value;
+        else { error = "unknown option " + arg; return false; }
+    }
+
+    if (engine_count != 2) { error = "two --engine are required"; return false; }
+    if (!has_limit) { options.base_ms = 10000; options.inc_ms = 100; }
+    if (options.sprt && (options.elo1 <= options.elo0 || options.alpha <= 0 || options.beta <= 0 ||
+                         options.alpha >= 1 || options.beta >= 1)) {
+        error = "invalid SPRT parameters";
+        return false;
+    }
+    for (int e = 0; e < 2; e++) {
+        MatchEngine& engine = options.engines[e];
+        if (engine.name.empty()) engine.name = engine.command.empty() ? "chess_engine" : engine.command;
+    }
+    if (options.engines[0].name == options.engines[1].name) {
+        options.engines[0].name += " #1";
+        options.engines[1].name += " #2";
+    }
+    return true;
+}
+
+bool run_match(const MatchOptions& options, std::ostream& out) {
+#ifndef _WIN32
+    signal(SIGPIPE, SIG_IGN); // Engine que cai no meio de um write não derruba o match
+#endif
+
+    std::vector<Opening> openings;
+    std::string error;
+    if (!load_openings(options.openings, options.opening_plies, openings, error)) {
+        std::cerr << "match: " << error << std::endl;
+        return false;
+    }
+
+    // Tablebases são globais e tb_init não é thread-safe: um só SyzygyPath
+    // para as engines em processo, carregado antes de qualquer busca
+    std::string syzygy_path;
+    for (const MatchEngine& spec : options.engines) {
+        if (!spec.command.empty()) continue;
+        for (const auto& option : spec.options) {
+            if (option.first != "SyzygyPath" || option.second.empty() || option.second == "<empty>") continue;
+            if (!syzygy_path.empty() && option.second != syzygy_path) {
+                std::cerr << "match: in-process engines must share one SyzygyPath" << std::endl;
+                return false;
+            }
+            syzygy_path = option.second;
+        }
+    }
+    if (!syzygy_path.empty() && !SyzygyTablebases::init(syzygy_path)) {
+        std::cerr << "match: no Syzygy tablebases in " << syzygy_path << std::endl;
+        return false;
+    }
+
+    // Valida as duas configurações antes de abrir os workers
+    for (const MatchEngine& spec : options.engines) {
+        std::unique_ptr<Player> probe = make_player(spec, error);
+        if (!probe || !probe->new_game(error)) {
+            std::cerr << "match: " << spec.name << ": " << error << std::endl;
+            return false;
+        }
+    }
+
+    std::ofstream pgn;
+    if (!options.pgn_out.empty()) {
+        pgn.open(options.pgn_out, std::ios::app);
+        if (!pgn) { std::cerr << "match: cannot write " << options.pgn_out << std::endl; return false; }
+    }
+
+    char date[16];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y.%m.%d", std::localtime(&now));
+
+    int concurrency = options.concurrency > 0 ? options.concurrency : (int)std::max(1u, std::thread::hardware_concurrency());
+    concurrency = std::min(concurrency, options.games);
+    const double lower = std::log(options.beta / (1 - options.alpha));
+    const double upper = std::log((1 - options.beta) / options.alpha);
+
+    out << "Match: " << options.engines[0].name << " vs " << options.engines[1].name
+        << ", " << options.games << " games, " << concurrency << " concurrent, "
+        << openings.size() << " opening(s), tc " << time_control_tag(options) << std::endl;
+
+    std::mutex mutex;
+    std::atomic<int> next_game{ 0 };
+    std::atomic<bool> stop{ false };
+    MatchScore score;
+    bool failed = false;
+
+    auto worker = [&]() {
+        std::unique_ptr<Player> engines[2];
+        for (int e = 0; e < 2; e++) {
+            std::string player_error;
+            engines[e] = make_player(options.engines[e], player_error);
+            if (!engines[e]) return; // Já validado acima; só falha por falta de recursos
+        }
+
+        while (!stop) {
+            int game = next_game++;
+            if (game >= options.games) break;
+
+            // Pares de partidas: mesma abertura, cores trocadas
+            const Opening& opening = openings[(size_t)(game / 2) % openings.size()];
+            int white = game % 2;
+            Player* players[2] = { engines[white].get(), engines[1 - white].get() };
+            const std::string& white_name = options.engines[white].name;
+            const std::string& black_name = options.engines[1 - white].name;
+
+            GameRecord record;
+            play_game(players, opening, options, record);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!record.error.empty()) {
+                out << "match: game " << game + 1 << " aborted: " << record.error << std::endl;
+                failed = true;
+                stop = true;
+                return;
+            }
+            if (record.result == "1/2-1/2") score.draws++;
+            else if ((record.result == "1-0") == (white == 0)) score.wins++;
+            else score.losses++;
+
+            out << "Finished game " << game + 1 << " (" << white_name << " vs " << black_name << "): "
+                << record.result << " {" << record.reason << "}\n";
+            print_score(out, score, options);
+            if (options.sprt) {
+                double llr = sprt_llr(score, options.elo0, options.elo1);
+                print_sprt(out, options, llr, lower, upper);
+                if (llr >= upper || llr <= lower) stop = true;
+            }
+            out.flush();
+            if (pgn.is_open()) write_pgn(pgn, record, white_name, black_name, game + 1, date, options);
+        }
+    };
+
+    auto start = Clock::now();
+    std::vector<std::thread> pool;
+    for (int t = 0; t < concurrency; t++) pool.emplace_back(worker);
+    for (auto& th : pool) th.join();
+
+    out << "\n";
+    print_score(out, score, options);
+    print_elo(out, score);
+    if (options.sprt) print_sprt(out, options, sprt_llr(score, options.elo0, options.elo1), lower, upper);
+    out << "Finished match in " << elapsed_ms(start) / 1000 << "s" << std::endl;
+    return !failed;
+}
@@ -0,0 +1,56 @@
+#ifndef MATCH_H
+#define MATCH_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Match entre duas engines, sem ferramentas externas: N partidas simultâneas,
+// aberturas de um EPD/PGN jogadas duas vezes com as cores trocadas, relógio,
+// adjudicação, PGN de saída, Elo com barra de erro e SPRT (parada antecipada).
+// Cada lado é a ChessEngine no próprio processo (sem "cmd=") ou um binário UCI.
+
+struct MatchEngine {
+    std::string name;
+    std::string command; // Vazio = ChessEngine em processo
+    std::vector<std::pair<std::string, std::string>> options; // option.<nome>=<valor>
+};
+
+struct MatchOptions {
+    MatchEngine engines[2];
+    int games = 100;
+    int concurrency = 0;       // 0 = número de núcleos
+    // Controle de tempo: [lances/]base[+incremento]; sem nenhum limite, 10+0.1
+    int tc_moves = 0;          // Lances por período (0 = partida inteira)
+    int base_ms = -1;
+    int inc_ms = 0;
+    int movetime = -1;
+    int depth = 0;
+    uint64_t nodes = 0;
+    int time_margin = 0;       // Tolerância antes de perder por tempo (ms)
+    std::string openings;      // .epd/.fen ou .pgn; vazio = posição inicial
+    int opening_plies = 0;     // Lances do PGN usados (0 = todos)
+    std::string pgn_out;
+    // SPRT (Elo logístico)
+    bool sprt = false;
+    double elo0 = 0, elo1 = 5, alpha = 0.05, beta = 0.05;
+    // Adjudicação (0 = desligada): empate com |score| <= draw_score por
+    // draw_movecount lances de cada lado a partir do lance draw_movenumber;
+    // derrota quando um lado vê <= -resign_score por resign_movecount lances
+    int draw_movenumber = 0, draw_movecount = 0, draw_score = 0;
+    int resign_movecount = 0, resign_score = 0;
+};
+
+// match --engine name=A [cmd=BIN] [option.Hash=64 ...] --engine name=B ...
+//       [--games N] [--concurrency N] [--tc [M/]S[+INC] | --movetime MS | --depth D | --nodes N]
+//       [--timemargin MS] [--openings ARQ] [--plies N] [--pgnout ARQ]
+//       [--sprt elo0=0 elo1=5 alpha=0.05 beta=0.05]
+//       [--draw movenumber=40 movecount=8 score=10] [--resign movecount=3 score=1000]
+bool parse_match_options(const std::vector<std::string>& args, MatchOptions& options, std::string& error);
+
+// Devolve false se as aberturas ou as engines não puderem ser carregadas
+bool run_match(const MatchOptions& options, std::ostream& out);
+
+#endif // MATCH_H
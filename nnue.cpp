@@ -0,0 +1,177 @@
+#include "nnue.h"
+#include <fstream>
+#include <cstring>
+
+// Kernels SIMD escolhidos em tempo de compilação (-march=native habilita o melhor)
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define NNUE_USE_AVX2
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#define NNUE_USE_SSSE3
+#endif
+
+const uint32_t NNUE_VERSION = 1;
+
+// --- KERNELS ---
+
+// acc += row (int16)
+static inline void add_row(int16_t* acc, const int16_t* row) {
+#if defined(NNUE_USE_AVX2)
+    for (int i = 0; i < NNUE_HIDDEN; i += 16) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(acc + i));
+        __m256i w = _mm256_loadu_si256((const __m256i*)(row + i));
+        _mm256_storeu_si256((__m256i*)(acc + i), _mm256_add_epi16(a, w));
+    }
+#elif defined(NNUE_USE_SSSE3)
+    for (int i = 0; i < NNUE_HIDDEN; i += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(acc + i));
+        __m128i w = _mm_loadu_si128((const __m128i*)(row + i));
+        _mm_storeu_si128((__m128i*)(acc + i), _mm_add_epi16(a, w));
+    }
+#else
+    for (int i = 0; i < NNUE_HIDDEN; i++) acc[i] += row[i];
+#endif
+}
+
+// acc -= row (int16)
+static inline void sub_row(int16_t* acc, const int16_t* row) {
+#if defined(NNUE_USE_AVX2)
+    for (int i = 0; i < NNUE_HIDDEN; i += 16) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(acc + i));
+        __m256i w = _mm256_loadu_si256((const __m256i*)(row + i));
+        _mm256_storeu_si256((__m256i*)(acc + i), _mm256_sub_epi16(a, w));
+    }
+#elif defined(NNUE_USE_SSSE3)
+    for (int i = 0; i < NNUE_HIDDEN; i += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(acc + i));
+        __m128i w = _mm_loadu_si128((const __m128i*)(row + i));
+        _mm_storeu_si128((__m128i*)(acc + i), _mm_sub_epi16(a, w));
+    }
+#else
+    for (int i = 0; i < NNUE_HIDDEN; i++) acc[i] -= row[i];
+#endif
+}
+
+// sum(clamp(acc, 0, QA) * weights): ativações viram uint8 e os pesos são int8
+static inline int32_t output_dot(const int16_t* acc, const int8_t* weights) {
+#if defined(NNUE_USE_AVX2)
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i qa = _mm256_set1_epi16(NNUE_QA);
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i sum = _mm256_setzero_si256();
+    for (int i = 0; i < NNUE_HIDDEN; i += 32) {
+        __m256i a0 = _mm256_loadu_si256((const __m256i*)(acc + i));
+        __m256i a1 = _mm256_loadu_si256((const __m256i*)(acc + i + 16));
+        a0 = _mm256_min_epi16(_mm256_max_epi16(a0, zero), qa);
+        a1 = _mm256_min_epi16(_mm256_max_epi16(a1, zero), qa);
+        // packus intercala as lanes de 128 bits; o permute restaura a ordem
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a0, a1), 0xD8);
+        __m256i w = _mm256_loadu_si256((const __m256i*)(weights + i));
+        __m256i prod = _mm256_maddubs_epi16(packed, w);
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(prod, ones));
+    }
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4E));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xB1));
+    return _mm_cvtsi128_si32(s);
+#elif defined(NNUE_USE_SSSE3)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i qa = _mm_set1_epi16(NNUE_QA);
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i sum = _mm_setzero_si128();
+    for (int i = 0; i < NNUE_HIDDEN; i += 16) {
+        __m128i a0 = _mm_loadu_si128((const __m128i*)(acc + i));
+        __m128i a1 = _mm_loadu_si128((const __m128i*)(acc + i + 8));
+        a0 = _mm_min_epi16(_mm_max_epi16(a0, zero), qa);
+        a1 = _mm_min_epi16(_mm_max_epi16(a1, zero), qa);
+        __m128i packed = _mm_packus_epi16(a0, a1);
+        __m128i w = _mm_loadu_si128((const __m128i*)(weights + i));
+        __m128i prod = _mm_maddubs_epi16(packed, w);
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(prod, ones));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    return _mm_cvtsi128_si32(sum);
+#else
+    int32_t sum = 0;
+    for (int i = 0; i < NNUE_HIDDEN; i++) {
+        int16_t v = acc[i] < 0 ? 0 : (acc[i] > NNUE_QA ? NNUE_QA : acc[i]);
+        sum += v * weights[i];
+    }
+    return sum;
+#endif
+}
+
+// --- REDE ---
+
+NNUENetwork::NNUENetwork() : out_bias(0), loaded(false) {}
+
+int NNUENetwork::feature_index(Color perspective, Color c, PieceType pt, Square sq) {
+    int relative_color = (c == perspective) ? 0 : 1;
+    int relative_sq = (perspective == WHITE) ? sq : (sq ^ 56);
+    return (relative_color * 6 + pt) * 64 + relative_sq;
+}
+
+bool NNUENetwork::load(const std::string& path) {
+    loaded = false;
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    char magic[4];
+    uint32_t version = 0, hidden = 0;
+    file.read(magic, 4);
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    file.read(reinterpret_cast<char*>(&hidden), sizeof(hidden));
+    if (!file || std::memcmp(magic, "CBNN", 4) != 0 || version != NNUE_VERSION || hidden != (uint32_t)NNUE_HIDDEN) {
+        return false;
+    }
+
+    ft_weights.resize(NNUE_INPUTS * NNUE_HIDDEN);
+    ft_bias.resize(NNUE_HIDDEN);
+    out_weights.resize(2 * NNUE_HIDDEN);
+    file.read(reinterpret_cast<char*>(ft_weights.data()), ft_weights.size() * sizeof(int16_t));
+    file.read(reinterpret_cast<char*>(ft_bias.data()), ft_bias.size() * sizeof(int16_t));
+    file.read(reinterpret_cast<char*>(out_weights.data()), out_weights.size() * sizeof(int8_t));
+    file.read(reinterpret_cast<char*>(&out_bias), sizeof(out_bias));
+    if (!file) return false;
+
+    loaded = true;
+    return true;
+}
+
+void NNUENetwork::refresh(const ChessBoard& board, NNUEAccumulator& acc) const {
+    for (int p = 0; p < 2; p++) {
+        std::memcpy(acc.values[p], ft_bias.data(), NNUE_HIDDEN * sizeof(int16_t));
+    }
+    for (Square sq = 0; sq < 64; sq++) {
+        PieceType pt = board.get_piece(sq);
+        if (pt == NONE) continue;
+        Color c = board.get_piece_color(sq);
+        for (int p = 0; p < 2; p++) {
+            add_row(acc.values[p], &ft_weights[feature_index((Color)p, c, pt, sq) * NNUE_HIDDEN]);
+        }
+    }
+}
+
+void NNUENetwork::update(const NNUEAccumulator& prev, NNUEAccumulator& next, const DirtyPieces& dirty) const {
+    for (int p = 0; p < 2; p++) {
+        std::memcpy(next.values[p], prev.values[p], NNUE_HIDDEN * sizeof(int16_t));
+        for (int i = 0; i < dirty.removed_count; i++) {
+            const DirtyPiece& d = dirty.removed[i];
+            sub_row(next.values[p], &ft_weights[feature_index((Color)p, d.color, d.piece, d.square) * NNUE_HIDDEN]);
+        }
+        for (int i = 0; i < dirty.added_count; i++) {
+            const DirtyPiece& d = dirty.added[i];
+            add_row(next.values[p], &ft_weights[feature_index((Color)p, d.color, d.piece, d.square) * NNUE_HIDDEN]);
+        }
+    }
+}
+
+int NNUENetwork::evaluate(const NNUEAccumulator& acc, Color side_to_move) const {
+    Color them = (side_to_move == WHITE) ? BLACK : WHITE;
+    int32_t output = output_dot(acc.values[side_to_move], &out_weights[0])
+                   + output_dot(acc.values[them], &out_weights[NNUE_HIDDEN])
+                   + out_bias;
+    return (int)((int64_t)output * NNUE_SCALE / (NNUE_QA * NNUE_QB));
+}
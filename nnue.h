@@ -0,0 +1,52 @@
+#ifndef NNUE_H
+#define NNUE_H
+
+#include "chess.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Rede neural eficientemente atualizável (NNUE), arquitetura (768 -> 256) x 2 -> 1.
+// Entradas: [cor relativa][peça][casa] do ponto de vista de cada lado.
+// O primeiro layer (acumulador) é atualizado incrementalmente a partir das
+// peças adicionadas/removidas em cada lance (ChessBoard::get_dirty_pieces).
+const int NNUE_INPUTS = 768;
+const int NNUE_HIDDEN = 256;
+
+// Quantização: ativações em [0, NNUE_QA], pesos de saída escalados por NNUE_QB
+const int NNUE_QA = 127;
+const int NNUE_QB = 64;
+const int NNUE_SCALE = 400; // Saída da rede -> centipawns
+
+// Acumulador do primeiro layer, uma perspectiva por cor
+struct alignas(64) NNUEAccumulator {
+    int16_t values[2][NNUE_HIDDEN];
+};
+
+class NNUENetwork {
+private:
+    std::vector<int16_t> ft_weights; // [NNUE_INPUTS][NNUE_HIDDEN]
+    std::vector<int16_t> ft_bias;    // [NNUE_HIDDEN]
+    std::vector<int8_t> out_weights; // [2 * NNUE_HIDDEN]: lado a jogar, depois o oponente
+    int32_t out_bias;
+    bool loaded;
+
+    static int feature_index(Color perspective, Color c, PieceType pt, Square sq);
+
+public:
+    NNUENetwork();
+
+    // Formato: "CBNN", versão (u32), hidden (u32), ft_weights (i16),
+    // ft_bias (i16), out_weights (i8), out_bias (i32), little-endian
+    bool load(const std::string& path);
+    bool is_loaded() const { return loaded; }
+
+    // Reconstrói o acumulador do zero (raiz da busca)
+    void refresh(const ChessBoard& board, NNUEAccumulator& acc) const;
+    // next = prev + peças adicionadas - peças removidas
+    void update(const NNUEAccumulator& prev, NNUEAccumulator& next, const DirtyPieces& dirty) const;
+    // Avaliação em centipawns do ponto de vista de side_to_move
+    int evaluate(const NNUEAccumulator& acc, Color side_to_move) const;
+};
+
+#endif // NNUE_H
@@ -0,0 +1,154 @@
+#include "polyglot.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+const size_t POLYGLOT_ENTRY_SIZE = 16;
+
+PolyglotBook::PolyglotBook() : data(nullptr), entry_count(0), mapped_size(0),
+#ifdef _WIN32
+    file_handle(nullptr), mapping_handle(nullptr)
+#else
+    fd(-1)
+#endif
+{}
+
+PolyglotBook::~PolyglotBook() { close(); }
+
+bool PolyglotBook::open(const std::string& path) {
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart < (LONGLONG)POLYGLOT_ENTRY_SIZE) { CloseHandle(file); return false; }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) { CloseHandle(file); return false; }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) { CloseHandle(mapping); CloseHandle(file); return false; }
+    file_handle = file;
+    mapping_handle = mapping;
+    mapped_size = (size_t)file_size.QuadPart;
+    data = static_cast<const unsigned char*>(view);
+#else
+    int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0) return false;
+    struct stat st;
+    if (fstat(file, &st) != 0 || st.st_size < (off_t)POLYGLOT_ENTRY_SIZE) { ::close(file); return false; }
+    void* view = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, file, 0);
+    if (view == MAP_FAILED) { ::close(file); return false; }
+    fd = file;
+    mapped_size = st.st_size;
+    data = static_cast<const unsigned char*>(view);
+#endif
+    entry_count = mapped_size / POLYGLOT_ENTRY_SIZE;
+    return true;
+}
+
+void PolyglotBook::close() {
+    if (!data) return;
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle((HANDLE)mapping_handle);
+    CloseHandle((HANDLE)file_handle);
+    file_handle = mapping_handle = nullptr;
+#else
+    munmap(const_cast<unsigned char*>(data), mapped_size);
+    ::close(fd);
+    fd = -1;
+#endif
+    data = nullptr;
+    entry_count = mapped_size = 0;
+}
+
+PolyglotEntry PolyglotBook::read_entry(size_t index) const {
+    const unsigned char* p = data + index * POLYGLOT_ENTRY_SIZE;
+    auto read_be = [](const unsigned char* bytes, int n) {
+        uint64_t v = 0;
+        for (int i = 0; i < n; i++) v = (v << 8) | bytes[i];
+        return v;
+    };
+    PolyglotEntry e;
+    e.key = read_be(p, 8);
+    e.move = (uint16_t)read_be(p + 8, 2);
+    e.weight = (uint16_t)read_be(p + 10, 2);
+    e.learn = (uint32_t)read_be(p + 12, 4);
+    return e;
+}
+
+// Converte o lance do livro no lance legal correspondente; Move() se não houver
+Move PolyglotBook::decode_move(const ChessBoard& board, uint16_t raw) {
+    Square to = ChessBoard::make_square(raw & 7, (raw >> 3) & 7);
+    Square from = ChessBoard::make_square((raw >> 6) & 7, (raw >> 9) & 7);
+    static const PieceType PROMOTIONS[5] = { NONE, KNIGHT, BISHOP, ROOK, QUEEN };
+    int promo = (raw >> 12) & 7;
+    PieceType promotion = (promo < 5) ? PROMOTIONS[promo] : NONE;
+
+    // Roque é codificado como "rei captura a própria torre" (e1h1, e1a1, ...)
+    if (board.get_piece(from) == KING && ChessBoard::get_file(from) == 4 &&
+        board.get_piece(to) == ROOK && board.get_piece_color(to) == board.get_piece_color(from)) {
+        to = (ChessBoard::get_file(to) == 7) ? from + 2 : from - 2;
+    }
+
+    Move wanted(from, to, promotion);
+    for (const Move& legal : board.generate_legal_moves()) {
+        if (legal == wanted) return legal;
+    }
+    return Move();
+}
+
+std::vector<BookMove> PolyglotBook::probe_all(const ChessBoard& board) const {
+    std::vector<BookMove> moves;
+    if (!data) return moves;
+
+    uint64_t key = board.polyglot_key();
+    // Busca binária pela primeira entrada com a chave
+    size_t lo = 0, hi = entry_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (read_entry(mid).key < key) lo = mid + 1;
+        else hi = mid;
+    }
+
+    for (size_t i = lo; i < entry_count; i++) {
+        PolyglotEntry e = read_entry(i);
+        if (e.key != key) break;
+        Move m = decode_move(board, e.move);
+        if (m.from != NO_SQUARE) moves.push_back({m, e.weight});
+    }
+    return moves;
+}
+
+bool PolyglotBook::probe(const ChessBoard& board, Move& move, bool best, std::mt19937& rng) const {
+    std::vector<BookMove> moves = probe_all(board);
+    if (moves.empty()) return false;
+
+    uint32_t total = 0;
+    size_t best_index = 0;
+    for (size_t i = 0; i < moves.size(); i++) {
+        total += moves[i].weight;
+        if (moves[i].weight > moves[best_index].weight) best_index = i;
+    }
+
+    if (best || total == 0) {
+        move = moves[best_index].move;
+        return true;
+    }
+
+    std::uniform_int_distribution<uint32_t> dist(0, total - 1);
+    uint32_t pick = dist(rng);
+    for (const BookMove& bm : moves) {
+        if (pick < bm.weight) { move = bm.move; return true; }
+        pick -= bm.weight;
+    }
+    move = moves[best_index].move;
+    return true;
+}
@@ -0,0 +1,59 @@
+#ifndef POLYGLOT_H
+#define POLYGLOT_H
+
+#include "chess.h"
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <random>
+
+// Entrada de um livro Polyglot (.bin): 16 bytes big-endian, ordenadas por chave
+struct PolyglotEntry {
+    uint64_t key;
+    uint16_t move;   // to_file | to_row << 3 | from_file << 6 | from_row << 9 | promo << 12
+    uint16_t weight;
+    uint32_t learn;
+};
+
+struct BookMove {
+    Move move;
+    uint16_t weight;
+};
+
+// Livro de aberturas Polyglot somente-leitura. O arquivo é mapeado em
+// memória (sem cópia) e as posições são achadas por busca binária.
+class PolyglotBook {
+private:
+    const unsigned char* data;
+    size_t entry_count;
+    size_t mapped_size;
+#ifdef _WIN32
+    void* file_handle;
+    void* mapping_handle;
+#else
+    int fd;
+#endif
+
+    PolyglotEntry read_entry(size_t index) const;
+    static Move decode_move(const ChessBoard& board, uint16_t raw);
+
+public:
+    PolyglotBook();
+    ~PolyglotBook();
+    PolyglotBook(const PolyglotBook&) = delete;
+    PolyglotBook& operator=(const PolyglotBook&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    bool is_open() const { return data != nullptr; }
+    size_t size() const { return entry_count; }
+
+    // Lances legais do livro para a posição (peso 0 incluso)
+    std::vector<BookMove> probe_all(const ChessBoard& board) const;
+
+    // best = true: lance de maior peso; senão sorteio proporcional ao peso
+    bool probe(const ChessBoard& board, Move& move, bool best, std::mt19937& rng) const;
+};
+
+#endif // POLYGLOT_H
@@ -0,0 +1,532 @@
+#include "server.h"
+#include "batch.h"
+#include "chess_engine.h"
+#include "game_rules.h"
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <queue>
+#include <map>
+#include <list>
+#include <algorithm>
+#include <cstdlib>
+#include <csignal>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <cerrno>
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const size_t LATENCY_WINDOW = 1024; // Percentis sobre os últimos N pedidos concluídos
+const int ACCEPT_POLL_MS = 200;     // Intervalo para notar SIGINT/SIGTERM
+
+std::atomic<bool> interrupted{ false };
+
+void on_signal(int) { interrupted = true; }
+
+double elapsed_ms(Clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+}
+
+std::string score_json(int score) {
+    if (int mate = ChessEngine::mate_in(score)) return "{\"mate\":" + std::to_string(mate) + "}";
+    return "{\"cp\":" + std::to_string(ChessEngine::score_to_cp(score)) + "}";
+}
+
+std::string pv_json(const std::vector<Move>& pv) {
+    std::string out = "[";
+    for (size_t i = 0; i < pv.size(); i++) out += (i ? ",\"" : "\"") + pv[i].to_string() + "\"";
+    return out + "]";
+}
+
+#ifndef _WIN32
+
+// Conexão de um cliente: o leitor e os workers escrevem nela
+class ServerClient {
+private:
+    int fd;
+    std::mutex write_mutex;
+    std::atomic<bool> open{ true };
+
+public:
+    std::atomic<bool> done{ false }; // Leitor terminou; a thread pode ser recolhida
+
+    explicit ServerClient(int fd) : fd(fd) {}
+    ~ServerClient() { close(fd); }
+
+    int socket() const { return fd; }
+    bool is_open() const { return open; }
+
+    // Uma linha inteira por chamada; erro de escrita descarta as próximas
+    void send(const std::string& line) {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        if (!open) return;
+        std::string data = line + "\n";
+        size_t written = 0;
+        while (written < data.size()) {
+            ssize_t n = write(fd, data.data() + written, data.size() - written);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) { open = false; return; }
+            written += (size_t)n;
+        }
+    }
+
+    void disconnect() {
+        open = false;
+        shutdown(fd, SHUT_RDWR);
+    }
+};
+
+struct AnalysisJob {
+    std::shared_ptr<ServerClient> client;
+    std::string id;
+    int priority = 0;
+    uint64_t sequence = 0;  // Desempate: ordem de chegada
+    ChessBoard board;
+    SearchLimits limits;
+    int multi_pv = 1;
+    Clock::time_point received;
+    std::atomic<bool> cancelled{ false };
+    ChessEngine* engine = nullptr; // Worker que está buscando (nullptr = na fila)
+};
+
+using JobPtr = std::shared_ptr<AnalysisJob>;
+
+// Maior prioridade primeiro; dentro da mesma prioridade, o mais antigo
+struct JobOrder {
+    bool operator()(const JobPtr& a, const JobPtr& b) const {
+        if (a->priority != b->priority) return a->priority < b->priority;
+        return a->sequence > b->sequence;
+    }
+};
+
+// Janela circular de latências (ms)
+class LatencyWindow {
+private:
+    std::vector<double> samples;
+    size_t next = 0;
+
+public:
+    void add(double ms) {
+        if (samples.size() < LATENCY_WINDOW) samples.push_back(ms);
+        else samples[next] = ms;
+        next = (next + 1) % LATENCY_WINDOW;
+    }
+
+    std::string json() const {
+        if (samples.empty()) return "null";
+        std::vector<double> sorted = samples;
+        std::sort(sorted.begin(), sorted.end());
+        auto at = [&](double q) { return sorted[std::min(sorted.size() - 1, (size_t)(q * sorted.size()))]; };
+        std::ostringstream out;
+        out.setf(std::ios::fixed);
+        out.precision(1);
+        out << "{\"p50\":" << at(0.50) << ",\"p90\":" << at(0.90) << ",\"p99\":" << at(0.99)
+            << ",\"max\":" << sorted.back() << "}";
+        return out.str();
+    }
+};
+
+class AnalysisServer {
+private:
+    const ServerOptions& options;
+    std::shared_ptr<TranspositionTable> tt;
+    std::vector<std::unique_ptr<ChessEngine>> engines;
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable queue_cv;
+    std::priority_queue<JobPtr, std::vector<JobPtr>, JobOrder> queue; // Pode conter cancelados
+    std::map<std::pair<ServerClient*, std::string>, JobPtr> active;   // Na fila ou em busca
+    size_t queued = 0, running = 0;
+    uint64_t sequence = 0, completed = 0, cancelled_count = 0, rejected = 0;
+    LatencyWindow wait_ms, total_ms; // Fila até a busca; chegada até o bestmove
+    bool stopping = false;
+    Clock::time_point started = Clock::now();
+
+    static std::string event(const std::string& id, const std::string& name) {
+        return "{\"id\":\"" + json_escape(id) + "\",\"event\":\"" + name + "\"";
+    }
+
+    void send_error(ServerClient& client, const std::string& id, const std::string& message) {
+        client.send(event(id, "error") + ",\"error\":\"" + json_escape(message) + "\"}");
+    }
+
+    // analyze <id> [priority N] [depth N] [nodes N] [movetime MS] [multipv N] position ...
+    void handle_analyze(const std::shared_ptr<ServerClient>& client, const std::vector<std::string>& tokens) {
+        if (tokens.size() < 2) { send_error(*client, "", "missing id"); return; }
+        auto job = std::make_shared<AnalysisJob>();
+        job->client = client;
+        job->id = tokens[1];
+        job->limits.move_overhead = 0;
+
+        size_t i = 2;
+        for (; i < tokens.size() && tokens[i] != "position"; i++) {
+            const std::string& key = tokens[i];
+            if (i + 1 >= tokens.size()) { send_error(*client, job->id, "missing value for " + key); return; }
+            const std::string& value = tokens[++i];
+            if (key == "priority") job->priority = std::atoi(value.c_str());
+            else if (key == "depth") job->limits.depth = std::max(0, std::atoi(value.c_str()));
+            else if (key == "nodes") job->limits.nodes = std::strtoull(value.c_str(), nullptr, 10);
+            else if (key == "movetime") job->limits.movetime = std::atoi(value.c_str());
+            else if (key == "multipv") job->multi_pv = std::max(1, std::atoi(value.c_str()));
+            else { send_error(*client, job->id, "unknown parameter " + key); return; }
+        }
+        if (job->limits.depth == 0 && job->limits.nodes == 0 && job->limits.movetime < 0) job->limits.depth = SERVER_DEFAULT_DEPTH;
+
+        std::string error;
+        if (!parse_position(tokens, i + 1, job->board, error)) { send_error(*client, job->id, error); return; }
+
+        size_t position = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto key = std::make_pair(client.get(), job->id);
+            if (active.count(key)) {
+                error = "duplicate id";
+            } else if (queued >= options.max_queue) {
+                error = "queue full";
+                rejected++;
+            } else {
+                job->sequence = sequence++;
+                job->received = Clock::now();
+                active[key] = job;
+                queue.push(job);
+                position = ++queued;
+                queue_cv.notify_one();
+            }
+        }
+        // Escritas fora do mutex: um cliente lento não trava a fila
+        if (!error.empty()) send_error(*client, job->id, error);
+        else client->send(event(job->id, "queued") + ",\"queued\":" + std::to_string(position) + "}");
+    }
+
+    // (startpos | fen <FEN>) [moves ...] a partir de tokens[i]
+    static bool parse_position(const std::vector<std::string>& tokens, size_t i, ChessBoard& board, std::string& error) {
+        if (i >= tokens.size()) { error = "missing position"; return false; }
+        std::string fen;
+        if (tokens[i] == "startpos") {
+            fen = START_FEN;
+            i++;
+        } else if (tokens[i] == "fen") {
+            std::vector<std::string> fields;
+            for (i++; i < tokens.size() && tokens[i] != "moves"; i++) fields.push_back(tokens[i]);
+            if (fields.size() < 4 || !valid_placement(fields[0]) || (fields[1] != "w" && fields[1] != "b")) {
+                error = "invalid position";
+                return false;
+            }
+            if (fields.size() < 5) fields.push_back("0");
+            if (fields.size() < 6) fields.push_back("1");
+            for (size_t f = 0; f < 6; f++) fen += (f ? " " : "") + fields[f];
+        } else {
+            error = "invalid position";
+            return false;
+        }
+        board.from_fen(fen);
+        if (!valid_position(board)) { error = "invalid position"; return false; }
+
+        if (i < tokens.size() && tokens[i] == "moves") {
+            for (i++; i < tokens.size(); i++) {
+                bool found = false;
+                if (tokens[i].size() >= 4) {
+                    Move wanted = Move::from_string(tokens[i]);
+                    for (const Move& legal : board.generate_legal_moves()) {
+                        if (legal == wanted) { board.make_move(legal); found = true; break; }
+                    }
+                }
+                if (!found) { error = "invalid move " + tokens[i]; return false; }
+            }
+        }
+        return true;
+    }
+
+    // Na fila: sai na hora. Em busca: a engine para e o worker responde.
+    void cancel(ServerClient* client, const std::string& id) {
+        JobPtr job;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = active.find(std::make_pair(client, id));
+            if (it == active.end()) return;
+            job = it->second;
+            job->cancelled = true;
+            if (job->engine) {
+                job->engine->stop();
+                return;
+            }
+            active.erase(it);
+            queued--;
+            cancelled_count++;
+        }
+        job->client->send(event(id, "cancelled") + "}");
+    }
+
+    std::string stats_json() {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::ostringstream out;
+        out << "{\"event\":\"stats\",\"queued\":" << queued << ",\"running\":" << running
+            << ",\"workers\":" << workers.size() << ",\"completed\":" << completed
+            << ",\"cancelled\":" << cancelled_count << ",\"rejected\":" << rejected
+            << ",\"hash_mb\":" << tt->size_mb() << ",\"hashfull\":" << tt->hashfull()
+            << ",\"uptime_s\":" << (int64_t)(elapsed_ms(started) / 1000)
+            << ",\"wait_ms\":" << wait_ms.json() << ",\"latency_ms\":" << total_ms.json() << "}";
+        return out.str();
+    }
+
+    void worker(ChessEngine& engine) {
+        while (true) {
+            JobPtr job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                queue_cv.wait(lock, [&] { return !queue.empty() || stopping; });
+                if (stopping) return;
+                job = queue.top();
+                queue.pop();
+                if (job->cancelled) continue; // Já respondido e fora de active
+                job->engine = &engine;
+                queued--;
+                running++;
+                wait_ms.add(elapsed_ms(job->received));
+            }
+
+            // Posições independentes: só a TT (compartilhada) sobrevive entre pedidos
+            engine.new_game();
+            engine.set_multi_pv(job->multi_pv);
+            // Resultados parciais; também pega um cancel que chegou antes de a busca começar
+            engine.set_iteration_callback([&](const SearchStats& stats) {
+                if (job->cancelled) { engine.stop(); return; }
+                std::ostringstream info;
+                info << event(job->id, "info") << ",\"depth\":" << stats.depth << ",\"seldepth\":" << stats.seldepth
+                     << ",\"nodes\":" << stats.nodes << ",\"nps\":" << stats.nps << ",\"time_ms\":" << stats.time_ms
+                     << ",\"lines\":[";
+                for (size_t i = 0; i < stats.multipv.size(); i++) {
+                    info << (i ? "," : "") << "{\"score\":" << score_json(stats.multipv[i].score)
+                         << ",\"pv\":" << pv_json(stats.multipv[i].pv) << "}";
+                }
+                info << "]}";
+                job->client->send(info.str());
+            });
+            Move best = engine.get_best_move(job->board, job->limits);
+            engine.set_iteration_callback(nullptr);
+            const SearchStats& stats = engine.get_search_stats();
+
+            std::string result;
+            if (job->cancelled) {
+                result = event(job->id, "cancelled") + "}";
+            } else {
+                std::ostringstream out;
+                out << event(job->id, "bestmove");
+                if (best.from == NO_SQUARE) out << ",\"bestmove\":null";
+                else out << ",\"bestmove\":\"" << best.to_string() << "\",\"score\":" << score_json(stats.score);
+                out << ",\"depth\":" << stats.depth << ",\"seldepth\":" << stats.seldepth << ",\"nodes\":" << stats.nodes
+                    << ",\"time_ms\":" << stats.time_ms << ",\"latency_ms\":" << (int64_t)elapsed_ms(job->received)
+                    << ",\"pv\":" << pv_json(stats.pv) << "}";
+                result = out.str();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                active.erase(std::make_pair(job->client.get(), job->id));
+                running--;
+                if (job->cancelled) {
+                    cancelled_count++;
+                } else {
+                    completed++;
+                    total_ms.add(elapsed_ms(job->received));
+                }
+            }
+            job->client->send(result);
+        }
+    }
+
+public:
+    AnalysisServer(const ServerOptions& options, std::shared_ptr<NNUENetwork> network) : options(options) {
+        tt = TTPool::instance().acquire(options.hash_mb);
+        for (int t = 0; t < std::max(1, options.threads); t++) {
+            engines.emplace_back(new ChessEngine());
+            engines.back()->set_silent(true);
+            engines.back()->set_network(network);
+            engines.back()->set_transposition_table(tt);
+        }
+        for (auto& engine : engines) workers.emplace_back([this, &engine] { worker(*engine); });
+    }
+
+    ~AnalysisServer() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            for (auto& entry : active) {
+                entry.second->cancelled = true;
+                if (entry.second->engine) entry.second->engine->stop();
+            }
+        }
+        queue_cv.notify_all();
+        for (auto& th : workers) th.join();
+    }
+
+    // Lê comandos até o cliente fechar; pedidos pendentes do cliente são cancelados
+    void serve_client(const std::shared_ptr<ServerClient>& client) {
+        std::string buffer;
+        char chunk[4096];
+        while (client->is_open()) {
+            ssize_t n = read(client->socket(), chunk, sizeof(chunk));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            buffer.append(chunk, (size_t)n);
+
+            size_t newline;
+            bool quit = false;
+            while (!quit && (newline = buffer.find('\n')) != std::string::npos) {
+                std::string line = buffer.substr(0, newline);
+                buffer.erase(0, newline + 1);
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+
+                std::istringstream ss(line);
+                std::vector<std::string> tokens;
+                for (std::string token; ss >> token;) tokens.push_back(token);
+                if (tokens.empty()) continue;
+
+                const std::string& command = tokens[0];
+                if (command == "analyze") handle_analyze(client, tokens);
+                else if (command == "cancel" && tokens.size() > 1) cancel(client.get(), tokens[1]);
+                else if (command == "stats") client->send(stats_json());
+                else if (command == "quit") quit = true;
+                else send_error(*client, "", "unknown command " + command);
+            }
+            if (quit) break;
+        }
+
+        std::vector<std::string> pending;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto& entry : active) {
+                if (entry.first.first == client.get()) pending.push_back(entry.first.second);
+            }
+        }
+        for (const std::string& id : pending) cancel(client.get(), id);
+        client->disconnect();
+        client->done = true;
+    }
+};
+
+int open_listener(const ServerOptions& options, std::string& error) {
+    int fd;
+    if (!options.unix_path.empty()) {
+        sockaddr_un addr = {};
+        if (options.unix_path.size() >= sizeof(addr.sun_path)) { error = "socket path too long"; return -1; }
+        addr.sun_family = AF_UNIX;
+        std::copy(options.unix_path.begin(), options.unix_path.end(), addr.sun_path);
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) { error = "socket failed"; return -1; }
+        unlink(options.unix_path.c_str()); // Socket de uma execução anterior
+        if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0) { error = "cannot bind " + options.unix_path; close(fd); return -1; }
+    } else {
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons((uint16_t)options.port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // Só conexões locais
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) { error = "socket failed"; return -1; }
+        int reuse = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0) { error = "cannot bind port " + std::to_string(options.port); close(fd); return -1; }
+    }
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    if (listen(fd, 64) < 0) { error = "listen failed"; close(fd); return -1; }
+    return fd;
+}
+
+#endif // _WIN32
+
+} // namespace
+
+bool parse_server_options(const std::vector<std::string>& args, ServerOptions& options, std::string& error) {
+    for (size_t i = 0; i < args.size(); i++) {
+        const std::string& arg = args[i];
+        if (arg.rfind("--", 0) == 0 && i + 1 >= args.size()) { error = "missing value for " + arg; return false; }
+        if (arg == "--unix") options.unix_path = args[++i];
+        else if (arg == "--port") options.port = std::atoi(args[++i].c_str());
+        else if (arg == "--threads") options.threads = std::max(1, std::atoi(args[++i].c_str()));
+        else if (arg == "--hash") options.hash_mb = std::max(1, std::atoi(args[++i].c_str()));
+        else if (arg == "--max-queue") options.max_queue = std::max(1, std::atoi(args[++i].c_str()));
+        else if (arg == "--network") options.network = args[++i];
+        else { error = "unknown option " + arg; return false; }
+    }
+    if (options.unix_path.empty() && (options.port <= 0 || options.port > 65535)) { error = "invalid port"; return false; }
+    return true;
+}
+
+bool run_server(const ServerOptions& options) {
+#ifndef _WIN32
+    signal(SIGPIPE, SIG_IGN); // Cliente que fecha no meio de um write não derruba o servidor
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+
+    std::shared_ptr<NNUENetwork> network;
+    if (!options.network.empty()) {
+        network = std::make_shared<NNUENetwork>();
+        if (!network->load(options.network)) {
+            std::cerr << "serve: cannot load network " << options.network << std::endl;
+            return false;
+        }
+    }
+
+    std::string error;
+    int listener = open_listener(options, error);
+    if (listener < 0) {
+        std::cerr << "serve: " << error << std::endl;
+        return false;
+    }
+
+    std::list<std::pair<std::thread, std::shared_ptr<ServerClient>>> clients;
+    {
+        AnalysisServer server(options, network);
+        std::cerr << "Listening on " << (options.unix_path.empty() ? "127.0.0.1:" + std::to_string(options.port) : options.unix_path)
+                  << " (" << std::max(1, options.threads) << " workers, hash " << options.hash_mb << " MB)" << std::endl;
+
+        while (!interrupted) {
+            pollfd pfd = { listener, POLLIN, 0 };
+            int ready = poll(&pfd, 1, ACCEPT_POLL_MS);
+
+            // Recolhe as threads de clientes que já desconectaram
+            for (auto it = clients.begin(); it != clients.end();) {
+                if (it->second->done) { it->first.join(); it = clients.erase(it); }
+                else ++it;
+            }
+            if (ready <= 0) continue;
+
+            int fd = accept(listener, nullptr, nullptr);
+            if (fd < 0) continue;
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+            auto client = std::make_shared<ServerClient>(fd);
+            clients.emplace_back(std::thread([&server, client] { server.serve_client(client); }), client);
+        }
+
+        // Encerramento: fecha as conexões (os leitores cancelam seus pedidos) e para os workers
+        for (auto& entry : clients) entry.second->disconnect();
+        for (auto& entry : clients) entry.first.join();
+    }
+
+    close(listener);
+    if (!options.unix_path.empty()) unlink(options.unix_path.c_str());
+    std::cerr << "Server stopped" << std::endl;
+    return true;
+#else
+    (void)options;
+    std::cerr << "serve: not supported on Windows" << std::endl;
+    return false;
+#endif
+}
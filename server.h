@@ -0,0 +1,38 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Servidor de análise local: um processo de longa duração escutando em um
+// socket Unix ou TCP em 127.0.0.1. Pedidos entram numa fila com prioridade e
+// rodam num pool fixo de workers que compartilham uma única TT grande.
+//
+// Protocolo em linhas de texto (cliente -> servidor):
+//   analyze <id> [priority N] [depth N] [nodes N] [movetime MS] [multipv N]
+//           position (startpos | fen <FEN>) [moves m1 m2 ...]
+//   cancel <id>
+//   stats
+//   quit
+// Respostas em NDJSON, com "event": queued, info (a cada iteração), bestmove,
+// cancelled, error ou stats. Os ids valem por conexão.
+const int SERVER_DEFAULT_PORT = 7680;
+const int SERVER_DEFAULT_DEPTH = 12; // Pedidos sem nenhum limite
+
+struct ServerOptions {
+    std::string unix_path;  // Vazio = TCP
+    int port = SERVER_DEFAULT_PORT;
+    int threads = 1;
+    size_t hash_mb = 256;   // TT única, compartilhada pelos workers
+    size_t max_queue = 1024; // Pedidos aguardando; acima disso o pedido é recusado
+    std::string network;    // Rede NNUE; vazio = avaliação manual
+};
+
+// serve [--unix PATH | --port N] [--threads N] [--hash MB] [--max-queue N] [--network ARQ]
+bool parse_server_options(const std::vector<std::string>& args, ServerOptions& options, std::string& error);
+
+// Roda até SIGINT/SIGTERM; devolve false se o socket não puder ser aberto
+bool run_server(const ServerOptions& options);
+
+#endif // SERVER_H
@@ -0,0 +1,178 @@
+#ifndef SHM_EVAL_H
+#define SHM_EVAL_H
+
+/*
+ * Avaliação em lote por memória compartilhada (lado do cliente, C99).
+ *
+ * O engine ("chess_uci shm-eval --name /nome") cria um anel de slots em
+ * memória compartilhada. O cliente escreve as posições direto nos slots e
+ * os workers do engine preenchem os resultados no mesmo slot, sem cópias:
+ * avaliação manual (evaluate_material), xeque, número de lances legais e o
+ * bitmap origem x destino dos lances legais.
+ *
+ * Um único cliente (uma thread) por anel:
+ *   1. escreve slots[i & (capacity - 1)] para i = submitted, submitted + 1, ...
+ *      sem passar de consumed + capacity, e chama shm_eval_publish();
+ *   2. lê os resultados na ordem, esperando cada slot com shm_eval_wait(),
+ *      e libera o slot com shm_eval_release().
+ * Os workers terminam fora de ordem; o estado por slot diz quando está pronto.
+ *
+ * Campainhas: futex (Linux) sobre contadores de 32 bits; o lado que vai
+ * dormir anuncia em *_sleeping e o outro só faz a syscall se houver alguém
+ * esperando. Fora do Linux a espera vira sleep curto.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#define SHM_EVAL_MAGIC 0x314C564545484353ULL /* "SCHEEVL1" */
+#define SHM_EVAL_VERSION 1
+
+/* Estado do slot */
+#define SHM_EVAL_SLOT_EMPTY 0
+#define SHM_EVAL_SLOT_SUBMITTED 1
+#define SHM_EVAL_SLOT_DONE 2
+
+/* Resultado */
+#define SHM_EVAL_OK 0
+#define SHM_EVAL_INVALID 1 /* Peças/reis inválidos ou lado que não joga em xeque */
+
+/* Estado do engine */
+#define SHM_EVAL_ENGINE_RUNNING 1
+#define SHM_EVAL_ENGINE_STOPPED 2
+
+#define SHM_EVAL_NO_SQUARE 64
+
+/* 576 bytes, alinhado em linhas de cache */
+typedef struct {
+    /* Entrada (cliente) */
+    uint8_t position[32];  /* PackedPosition de training_data.h (result/score ignorados) */
+    uint8_t castling;      /* 1 = K, 2 = Q, 4 = k, 8 = q */
+    uint8_t ep_square;     /* 0..63 (a1 = 0) ou SHM_EVAL_NO_SQUARE */
+    /* Saída (engine) */
+    uint8_t status;
+    uint8_t in_check;      /* Lado a jogar em xeque */
+    uint32_t state;        /* SHM_EVAL_SLOT_* (atômico) */
+    int32_t score;         /* evaluate_material, centipawns, ponto de vista das brancas */
+    uint16_t move_count;   /* Lances legais (promoções contam as 4 peças) */
+    uint8_t reserved[18];
+    uint64_t moves[64];    /* Bit (origem * 64 + destino); promoções compartilham o bit */
+} shm_eval_slot;
+
+typedef struct {
+    uint64_t magic;            /* Escrito por último: o anel está pronto */
+    uint32_t version;
+    uint32_t capacity;         /* Potência de 2 */
+    uint32_t slot_size;        /* sizeof(shm_eval_slot) */
+    uint32_t engine_state;     /* SHM_EVAL_ENGINE_* */
+    uint32_t workers;
+    uint8_t pad0[36];
+
+    /* Linha do cliente */
+    uint64_t submitted;        /* Slots publicados */
+    uint32_t submit_doorbell;  /* Futex: incrementado a cada publicação */
+    uint32_t engine_sleeping;  /* Workers esperando a campainha */
+    uint8_t pad1[48];
+
+    /* Linha do engine */
+    uint64_t claimed;          /* Próximo slot a processar */
+    uint32_t done_doorbell;    /* Futex: incrementado a cada slot pronto */
+    uint32_t client_sleeping;
+    uint8_t pad2[48];
+} shm_eval_header;
+
+/* Slots começam logo após o cabeçalho (192 bytes) */
+static inline shm_eval_slot* shm_eval_slots(shm_eval_header* header) {
+    return (shm_eval_slot*)(header + 1);
+}
+
+static inline size_t shm_eval_size(uint32_t capacity) {
+    return sizeof(shm_eval_header) + (size_t)capacity * sizeof(shm_eval_slot);
+}
+
+static inline void shm_eval_futex_wait(uint32_t* word, uint32_t expected, int timeout_ms) {
+#ifdef __linux__
+    struct timespec ts;
+    ts.tv_sec = timeout_ms / 1000;
+    ts.tv_nsec = (long)(timeout_ms % 1000) * 1000000L;
+    syscall(SYS_futex, word, FUTEX_WAIT, expected, &ts, NULL, 0);
+#else
+    (void)word; (void)expected; (void)timeout_ms;
+    usleep(50);
+#endif
+}
+
+static inline void shm_eval_futex_wake(uint32_t* word) {
+#ifdef __linux__
+    syscall(SYS_futex, word, FUTEX_WAKE, 0x7fffffff, NULL, NULL, 0);
+#else
+    (void)word;
+#endif
+}
+
+/* Mapeia o anel criado pelo engine; NULL se não existir ou for incompatível */
+static inline shm_eval_header* shm_eval_attach(const char* name) {
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(shm_eval_header)) { close(fd); return NULL; }
+    void* mem = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED) return NULL;
+    shm_eval_header* header = (shm_eval_header*)mem;
+    if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != SHM_EVAL_MAGIC || header->version != SHM_EVAL_VERSION ||
+        header->slot_size != sizeof(shm_eval_slot) || (size_t)st.st_size < shm_eval_size(header->capacity)) {
+        munmap(mem, (size_t)st.st_size);
+        return NULL;
+    }
+    return header;
+}
+
+static inline void shm_eval_detach(shm_eval_header* header) {
+    munmap(header, shm_eval_size(header->capacity));
+}
+
+/* Publica os slots escritos até submitted (exclusivo) e acorda os workers */
+static inline void shm_eval_publish(shm_eval_header* header, uint64_t submitted) {
+    __atomic_store_n(&header->submitted, submitted, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&header->submit_doorbell, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&header->engine_sleeping, __ATOMIC_SEQ_CST)) shm_eval_futex_wake(&header->submit_doorbell);
+}
+
+/* Marca o slot como enviado (antes de shm_eval_publish) */
+static inline void shm_eval_submit(shm_eval_slot* slot) {
+    __atomic_store_n(&slot->state, SHM_EVAL_SLOT_SUBMITTED, __ATOMIC_RELAXED);
+}
+
+/* Espera o resultado do slot; 0 se o engine parou antes */
+static inline int shm_eval_wait(shm_eval_header* header, shm_eval_slot* slot) {
+    for (int spin = 0; spin < 2000; spin++) {
+        if (__atomic_load_n(&slot->state, __ATOMIC_ACQUIRE) == SHM_EVAL_SLOT_DONE) return 1;
+    }
+    while (1) {
+        __atomic_add_fetch(&header->client_sleeping, 1, __ATOMIC_SEQ_CST);
+        uint32_t seen = __atomic_load_n(&header->done_doorbell, __ATOMIC_SEQ_CST);
+        int done = __atomic_load_n(&slot->state, __ATOMIC_SEQ_CST) == SHM_EVAL_SLOT_DONE;
+        if (!done) shm_eval_futex_wait(&header->done_doorbell, seen, 100);
+        __atomic_sub_fetch(&header->client_sleeping, 1, __ATOMIC_SEQ_CST);
+        if (done || __atomic_load_n(&slot->state, __ATOMIC_ACQUIRE) == SHM_EVAL_SLOT_DONE) return 1;
+        if (__atomic_load_n(&header->engine_state, __ATOMIC_ACQUIRE) != SHM_EVAL_ENGINE_RUNNING) return 0;
+    }
+}
+
+/* Resultado lido: o slot pode receber outra posição */
+static inline void shm_eval_release(shm_eval_slot* slot) {
+    __atomic_store_n(&slot->state, SHM_EVAL_SLOT_EMPTY, __ATOMIC_RELAXED);
+}
+
+#endif /* SHM_EVAL_H */
@@ -0,0 +1,132 @@
+/*
+ * Benchmark de throughput do anel shm_eval (cliente em C, só shm_eval.h)
+ * Uso: ./chess_uci shm-eval --name /chess_eval --threads 4 &
+ *      ./shm_eval_bench [/nome] [posições]
+ */
+
+#include "shm_eval.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+
+typedef struct {
+    uint8_t position[32];
+    uint8_t castling;
+    uint8_t ep_square;
+} packed_input;
+
+/* FEN -> PackedPosition (training_data.h) + roque/en passant */
+static int pack_fen(const char* fen, packed_input* out) {
+    static const char SYMBOLS[] = "PNBRQKpnbrqk";
+    memset(out, 0, sizeof(*out));
+    uint64_t occupied = 0;
+    int codes[64];
+    int rank = 7, file = 0;
+    const char* p = fen;
+    for (; *p && *p != ' '; p++) {
+        if (*p == '/') { rank--; file = 0; continue; }
+        if (isdigit((unsigned char)*p)) { file += *p - '0'; continue; }
+        const char* symbol = strchr(SYMBOLS, *p);
+        if (!symbol || rank < 0 || file > 7) return 0;
+        int sq = rank * 8 + file++;
+        occupied |= 1ULL << sq;
+        codes[sq] = (int)(symbol - SYMBOLS);
+    }
+    int count = 0;
+    for (int sq = 0; sq < 64; sq++) {
+        if (!(occupied & (1ULL << sq))) continue;
+        if (count == 32) return 0;
+        out->position[8 + count / 2] |= (uint8_t)(codes[sq] << ((count & 1) * 4));
+        count++;
+    }
+    memcpy(out->position, &occupied, 8); /* Little-endian */
+
+    char side = 'w', castling[8] = "-", ep[4] = "-";
+    sscanf(p, " %c %7s %3s", &side, castling, ep);
+    out->position[24] = (side == 'b') ? 1 : 0;
+    for (const char* c = castling; *c; c++) {
+        if (*c == 'K') out->castling |= 1;
+        if (*c == 'Q') out->castling |= 2;
+        if (*c == 'k') out->castling |= 4;
+        if (*c == 'q') out->castling |= 8;
+    }
+    out->ep_square = (ep[0] >= 'a' && ep[0] <= 'h' && ep[1] >= '1' && ep[1] <= '8')
+                   ? (uint8_t)((ep[1] - '1') * 8 + (ep[0] - 'a')) : SHM_EVAL_NO_SQUARE;
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+    const char* fens[] = {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "r1bq1rk1/pp2bppp/2n1pn2/3p4/2PP4/2N1PN2/PP1B1PPP/R2QKB1R w KQ - 0 8",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3"
+    };
+    /* Lances legais conhecidos (perft 1) */
+    const int expected_moves[] = { 20, 48, 34, 6, 14, 31 };
+    const int count = (int)(sizeof(fens) / sizeof(fens[0]));
+
+    const char* name = (argc > 1) ? argv[1] : "/chess_eval";
+    uint64_t total = (argc > 2) ? strtoull(argv[2], NULL, 10) : 10000000ULL;
+
+    shm_eval_header* header = shm_eval_attach(name);
+    if (!header) {
+        fprintf(stderr, "Anel %s nao encontrado (rode ./chess_uci shm-eval --name %s)\n", name, name);
+        return 1;
+    }
+
+    packed_input inputs[6];
+    for (int i = 0; i < count; i++) pack_fen(fens[i], &inputs[i]);
+
+    shm_eval_slot* slots = shm_eval_slots(header);
+    const uint64_t capacity = header->capacity, mask = capacity - 1;
+    uint64_t submitted = __atomic_load_n(&header->submitted, __ATOMIC_ACQUIRE);
+    uint64_t consumed = submitted, end = submitted + total;
+    long long checksum = 0, errors = 0;
+
+    struct timespec start, finish;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (consumed < end) {
+        /* Enche o anel e publica de uma vez (uma campainha por lote) */
+        while (submitted < end && submitted - consumed < capacity) {
+            shm_eval_slot* slot = &slots[submitted & mask];
+            const packed_input* in = &inputs[submitted % count];
+            memcpy(slot->position, in->position, sizeof(in->position));
+            slot->castling = in->castling;
+            slot->ep_square = in->ep_square;
+            shm_eval_submit(slot);
+            submitted++;
+        }
+        shm_eval_publish(header, submitted);
+
+        /* Consome até metade do anel ficar livre */
+        while (consumed < submitted && (submitted == end || submitted - consumed > capacity / 2)) {
+            shm_eval_slot* slot = &slots[consumed & mask];
+            if (!shm_eval_wait(header, slot)) {
+                fprintf(stderr, "Engine parou\n");
+                shm_eval_detach(header);
+                return 1;
+            }
+            int index = (int)(consumed % count);
+            if (slot->status != SHM_EVAL_OK || slot->move_count != expected_moves[index]) errors++;
+            checksum += slot->score + slot->move_count + slot->in_check;
+            shm_eval_release(slot);
+            consumed++;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &finish);
+
+    double seconds = (double)(finish.tv_sec - start.tv_sec) + (double)(finish.tv_nsec - start.tv_nsec) / 1e9;
+    printf("Posicoes: %llu\n", (unsigned long long)total);
+    printf("Workers: %u\n", header->workers);
+    printf("Tempo: %.3f s\n", seconds);
+    printf("Posicoes/s: %llu\n", (unsigned long long)(total / (seconds > 0 ? seconds : 1e-9)));
+    printf("Checksum: %lld\n", checksum);
+    printf("Erros: %lld\n", errors);
+    shm_eval_detach(header);
+    return errors ? 1 : 0;
+}
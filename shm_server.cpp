@@ -0,0 +1,205 @@
+#include "shm_server.h"
+#include "batch.h"
+#include "chess_engine.h"
+#include "training_data.h"
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <csignal>
+
+#ifndef _WIN32
+#include "shm_eval.h"
+#endif
+
+namespace {
+
+const int IDLE_SPINS = 4000;   // Voltas sem trabalho antes de dormir na campainha
+const uint64_t CLAIM_BATCH = 8; // Slots reservados por CAS
+
+std::atomic<bool> interrupted{ false };
+
+void on_signal(int) { interrupted = true; }
+
+#ifndef _WIN32
+
+// Descarta direitos de roque sem rei/torre na casa inicial e en passant
+// impossível: o gerador de lances confia nesses campos
+int sanitize_castling(int castling, const std::array<Bitboard, 6> pieces[2]) {
+    const Bitboard e1 = 1ULL << 4, h1 = 1ULL << 7, a1 = 1ULL << 0;
+    const Bitboard e8 = 1ULL << 60, h8 = 1ULL << 63, a8 = 1ULL << 56;
+    bool white_king = pieces[WHITE][KING] & e1, black_king = pieces[BLACK][KING] & e8;
+    int result = 0;
+    if ((castling & 1) && white_king && (pieces[WHITE][ROOK] & h1)) result |= 1;
+    if ((castling & 2) && white_king && (pieces[WHITE][ROOK] & a1)) result |= 2;
+    if ((castling & 4) && black_king && (pieces[BLACK][ROOK] & h8)) result |= 4;
+    if ((castling & 8) && black_king && (pieces[BLACK][ROOK] & a8)) result |= 8;
+    return result;
+}
+
+Square sanitize_ep(int ep, Color side, const std::array<Bitboard, 6> pieces[2], Bitboard occupied) {
+    if (ep < 0 || ep >= 64) return NO_SQUARE;
+    int rank = ChessBoard::get_rank(ep);
+    Square pawn = (side == WHITE) ? ep - 8 : ep + 8; // Peão que acabou de andar duas casas
+    Color them = (side == WHITE) ? BLACK : WHITE;
+    if (rank != (side == WHITE ? 5 : 2) || (occupied & (1ULL << ep)) || !(pieces[them][PAWN] & (1ULL << pawn))) return NO_SQUARE;
+    return ep;
+}
+
+void fill_slot(const ChessEngine& engine, ChessBoard& board, shm_eval_slot& slot) {
+    PackedPosition packed;
+    std::memcpy(&packed, slot.position, sizeof(packed));
+
+    std::array<Bitboard, 6> pieces[2] = {};
+    bool ok = __builtin_popcountll(packed.occupied) <= 32;
+    int count = 0;
+    for (Bitboard bb = packed.occupied; ok && bb; bb &= bb - 1, count++) {
+        int code = (packed.pieces[count / 2] >> ((count & 1) * 4)) & 0xF;
+        if (code >= 12) ok = false;
+        else pieces[code / 6][code % 6] |= 1ULL << __builtin_ctzll(bb);
+    }
+    // Peões na primeira/última fileira quebrariam o gerador de lances
+    const Bitboard back_ranks = 0xFF000000000000FFULL;
+    if ((pieces[WHITE][PAWN] | pieces[BLACK][PAWN]) & back_ranks) ok = false;
+
+    if (ok) {
+        Color side = (packed.side_to_move == BLACK) ? BLACK : WHITE;
+        board.set_position(pieces[WHITE], pieces[BLACK], side, sanitize_castling(slot.castling, pieces),
+                           sanitize_ep(slot.ep_square, side, pieces, packed.occupied));
+        ok = valid_position(board);
+    }
+
+    std::memset(slot.moves, 0, sizeof(slot.moves));
+    if (!ok) {
+        slot.status = SHM_EVAL_INVALID;
+        slot.score = 0;
+        slot.in_check = 0;
+        slot.move_count = 0;
+        return;
+    }
+
+    std::vector<Move> moves = board.generate_legal_moves();
+    for (const Move& m : moves) {
+        int index = m.from * 64 + m.to;
+        slot.moves[index / 64] |= 1ULL << (index % 64);
+    }
+    slot.status = SHM_EVAL_OK;
+    slot.score = engine.static_evaluation(board);
+    slot.in_check = board.is_check(board.get_side_to_move()) ? 1 : 0;
+    slot.move_count = (uint16_t)moves.size();
+}
+
+// Reserva slots publicados (CAS em claimed), preenche e avisa o cliente
+void worker(shm_eval_header* header, const ChessEngine& engine, std::atomic<uint64_t>& processed) {
+    shm_eval_slot* slots = shm_eval_slots(header);
+    const uint64_t mask = header->capacity - 1;
+    ChessBoard board;
+    int idle = 0;
+
+    while (!interrupted) {
+        uint64_t claimed = __atomic_load_n(&header->claimed, __ATOMIC_ACQUIRE);
+        uint64_t submitted = __atomic_load_n(&header->submitted, __ATOMIC_ACQUIRE);
+        if (claimed < submitted) {
+            uint64_t count = std::min(CLAIM_BATCH, submitted - claimed);
+            if (!__atomic_compare_exchange_n(&header->claimed, &claimed, claimed + count, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) continue;
+            for (uint64_t i = claimed; i < claimed + count; i++) {
+                shm_eval_slot& slot = slots[i & mask];
+                fill_slot(engine, board, slot);
+                __atomic_store_n(&slot.state, SHM_EVAL_SLOT_DONE, __ATOMIC_RELEASE);
+            }
+            __atomic_add_fetch(&header->done_doorbell, 1, __ATOMIC_SEQ_CST);
+            if (__atomic_load_n(&header->client_sleeping, __ATOMIC_SEQ_CST)) shm_eval_futex_wake(&header->done_doorbell);
+            processed += count;
+            idle = 0;
+            continue;
+        }
+        if (++idle < IDLE_SPINS) continue;
+
+        // Anuncia que vai dormir e confere de novo: a publicação do cliente
+        // ou é vista aqui, ou vê engine_sleeping e toca a campainha
+        idle = 0;
+        __atomic_add_fetch(&header->engine_sleeping, 1, __ATOMIC_SEQ_CST);
+        uint32_t seen = __atomic_load_n(&header->submit_doorbell, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&header->claimed, __ATOMIC_SEQ_CST) >= __atomic_load_n(&header->submitted, __ATOMIC_SEQ_CST)) {
+            shm_eval_futex_wait(&header->submit_doorbell, seen, 100);
+        }
+        __atomic_sub_fetch(&header->engine_sleeping, 1, __ATOMIC_SEQ_CST);
+    }
+}
+
+#endif // _WIN32
+
+} // namespace
+
+bool parse_shm_options(const std::vector<std::string>& args, ShmServerOptions& options, std::string& error) {
+    for (size_t i = 0; i < args.size(); i++) {
+        const std::string& arg = args[i];
+        if (arg.rfind("--", 0) == 0 && i + 1 >= args.size()) { error = "missing value for " + arg; return false; }
+        if (arg == "--name") options.name = args[++i];
+        else if (arg == "--slots") options.slots = (uint32_t)std::max(1, std::atoi(args[++i].c_str()));
+        else if (arg == "--threads") options.threads = std::max(1, std::atoi(args[++i].c_str()));
+        else { error = "unknown option " + arg; return false; }
+    }
+    if (options.name.empty() || options.name[0] != '/') { error = "name must start with /"; return false; }
+    uint32_t slots = 1;
+    while (slots < options.slots && slots < (1u << 24)) slots *= 2;
+    options.slots = slots;
+    return true;
+}
+
+bool run_shm_server(const ShmServerOptions& options) {
+#ifndef _WIN32
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+
+    size_t size = shm_eval_size(options.slots);
+    shm_unlink(options.name.c_str()); // Anel de uma execução anterior
+    int fd = shm_open(options.name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0 || ftruncate(fd, (off_t)size) < 0) {
+        std::cerr << "shm-eval: cannot create " << options.name << std::endl;
+        if (fd >= 0) { close(fd); shm_unlink(options.name.c_str()); }
+        return false;
+    }
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) {
+        std::cerr << "shm-eval: mmap failed" << std::endl;
+        shm_unlink(options.name.c_str());
+        return false;
+    }
+
+    std::memset(memory, 0, size);
+    shm_eval_header* header = static_cast<shm_eval_header*>(memory);
+    header->version = SHM_EVAL_VERSION;
+    header->capacity = options.slots;
+    header->slot_size = sizeof(shm_eval_slot);
+    header->workers = (uint32_t)options.threads;
+    header->engine_state = SHM_EVAL_ENGINE_RUNNING;
+    __atomic_store_n(&header->magic, SHM_EVAL_MAGIC, __ATOMIC_RELEASE);
+
+    // Só a avaliação manual, que é const e sem estado: uma engine para todos os workers
+    ChessEngine engine;
+    std::atomic<uint64_t> processed{ 0 };
+    std::vector<std::thread> pool;
+    for (int t = 0; t < options.threads; t++) pool.emplace_back(worker, header, std::cref(engine), std::ref(processed));
+    std::cerr << "Ring " << options.name << ": " << options.slots << " slots, " << options.threads << " workers" << std::endl;
+
+    while (!interrupted) std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    __atomic_store_n(&header->engine_state, SHM_EVAL_ENGINE_STOPPED, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&header->done_doorbell, 1, __ATOMIC_SEQ_CST);
+    shm_eval_futex_wake(&header->done_doorbell);
+    for (auto& th : pool) th.join();
+
+    std::cerr << "Positions       : " << processed << std::endl;
+    munmap(memory, size);
+    shm_unlink(options.name.c_str());
+    return true;
+#else
+    (void)options;
+    std::cerr << "shm-eval: not supported on Windows" << std::endl;
+    return false;
+#endif
+}
@@ -0,0 +1,23 @@
+#ifndef SHM_SERVER_H
+#define SHM_SERVER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Lado do engine da avaliação por memória compartilhada (protocolo em
+// shm_eval.h): cria o anel, e um pool de workers preenche os slots enviados
+// pelo cliente até SIGINT/SIGTERM.
+struct ShmServerOptions {
+    std::string name = "/chess_eval"; // Nome POSIX (shm_open)
+    uint32_t slots = 4096;            // Arredondado para potência de 2
+    int threads = 1;
+};
+
+// shm-eval [--name /NOME] [--slots N] [--threads N]
+bool parse_shm_options(const std::vector<std::string>& args, ShmServerOptions& options, std::string& error);
+
+// Devolve false se a memória compartilhada não puder ser criada
+bool run_shm_server(const ShmServerOptions& options);
+
+#endif // SHM_SERVER_H
@@ -0,0 +1,80 @@
+#include "syzygy.h"
+
+#ifdef USE_SYZYGY
+#include "tbprobe.h"
+
+namespace {
+    SyzygyWDL to_wdl(unsigned result) {
+        switch (TB_GET_WDL(result)) {
+            case TB_LOSS: return TB_WDL_LOSS;
+            case TB_BLESSED_LOSS: return TB_WDL_BLESSED_LOSS;
+            case TB_CURSED_WIN: return TB_WDL_CURSED_WIN;
+            case TB_WIN: return TB_WDL_WIN;
+            default: return TB_WDL_DRAW;
+        }
+    }
+}
+
+bool SyzygyTablebases::has_castling(const ChessBoard& board) {
+    return board.castling_rights[WHITE][0] || board.castling_rights[WHITE][1] ||
+           board.castling_rights[BLACK][0] || board.castling_rights[BLACK][1];
+}
+
+bool SyzygyTablebases::init(const std::string& path) {
+    if (path.empty() || path == "<empty>") { free(); return false; }
+    return tb_init(path.c_str()) && TB_LARGEST > 0;
+}
+
+void SyzygyTablebases::free() { tb_free(); }
+int SyzygyTablebases::largest() { return (int)TB_LARGEST; }
+bool SyzygyTablebases::compiled_in() { return true; }
+
+bool SyzygyTablebases::probe_wdl(const ChessBoard& board, SyzygyWDL& wdl) {
+    if (board.halfmove_clock != 0 || has_castling(board)) return false;
+    const auto& w = board.pieces_white;
+    const auto& b = board.pieces_black;
+    unsigned result = tb_probe_wdl(board.all_white, board.all_black,
+        w[KING] | b[KING], w[QUEEN] | b[QUEEN], w[ROOK] | b[ROOK],
+        w[BISHOP] | b[BISHOP], w[KNIGHT] | b[KNIGHT], w[PAWN] | b[PAWN],
+        0, 0, board.en_passant_square == NO_SQUARE ? 0 : board.en_passant_square,
+        board.side_to_move == WHITE);
+    if (result == TB_RESULT_FAILED) return false;
+    wdl = to_wdl(result);
+    return true;
+}
+
+bool SyzygyTablebases::probe_root(const ChessBoard& board, Move& move, SyzygyWDL& wdl) {
+    if (has_castling(board)) return false;
+    const auto& w = board.pieces_white;
+    const auto& b = board.pieces_black;
+    unsigned result = tb_probe_root(board.all_white, board.all_black,
+        w[KING] | b[KING], w[QUEEN] | b[QUEEN], w[ROOK] | b[ROOK],
+        w[BISHOP] | b[BISHOP], w[KNIGHT] | b[KNIGHT], w[PAWN] | b[PAWN],
+        board.halfmove_clock, 0, board.en_passant_square == NO_SQUARE ? 0 : board.en_passant_square,
+        board.side_to_move == WHITE, nullptr);
+    if (result == TB_RESULT_FAILED || result == TB_RESULT_CHECKMATE || result == TB_RESULT_STALEMATE) return false;
+
+    static const PieceType PROMOTIONS[5] = { NONE, QUEEN, ROOK, BISHOP, KNIGHT };
+    unsigned promotes = TB_GET_PROMOTES(result);
+    Move wanted(TB_GET_FROM(result), TB_GET_TO(result), promotes < 5 ? PROMOTIONS[promotes] : NONE);
+    for (const Move& legal : board.generate_legal_moves()) {
+        if (legal == wanted) {
+            move = legal;
+            wdl = to_wdl(result);
+            return true;
+        }
+    }
+    return false;
+}
+
+#else // Sem Fathom: tablebases indisponíveis
+
+bool SyzygyTablebases::has_castling(const ChessBoard&) { return false; }
+bool SyzygyTablebases::init(const std::string&) { return false; }
+void SyzygyTablebases::free() {}
+int SyzygyTablebases::largest() { return 0; }
+bool SyzygyTablebases::compiled_in() { return false; }
+bool SyzygyTablebases::probe_wdl(const ChessBoard&, SyzygyWDL&) { return false; }
+bool SyzygyTablebases::probe_root(const ChessBoard&, Move&, SyzygyWDL&) { return false; }
+
+#endif // USE_SYZYGY
@@ -0,0 +1,40 @@
+#ifndef SYZYGY_H
+#define SYZYGY_H
+
+#include "chess.h"
+#include <string>
+
+// Tablebases Syzygy (WDL/DTZ). A decodificação fica a cargo do Fathom
+// (https://github.com/jdart1/Fathom), que mapeia os arquivos .rtbw/.rtbz em
+// memória. É opcional: sem USE_SYZYGY tudo compila e init() apenas falha.
+// O estado do Fathom é global ao processo, por isso a classe é estática.
+enum SyzygyWDL {
+    TB_WDL_LOSS = -2,
+    TB_WDL_BLESSED_LOSS = -1, // Perde, mas empata pela regra dos 50 lances
+    TB_WDL_DRAW = 0,
+    TB_WDL_CURSED_WIN = 1,    // Ganha, mas empata pela regra dos 50 lances
+    TB_WDL_WIN = 2
+};
+
+class SyzygyTablebases {
+private:
+    static bool has_castling(const ChessBoard& board);
+
+public:
+    // Carrega as tabelas dos diretórios em path (separados por ':' ou ';').
+    // "" ou "<empty>" descarrega.
+    static bool init(const std::string& path);
+    static void free();
+    static bool available() { return largest() > 0; }
+    static int largest(); // Maior número de peças coberto (0 = nenhuma tabela)
+    static bool compiled_in();
+
+    // WDL do ponto de vista do lado a jogar. Só é possível logo após um lance
+    // que zera a contagem dos 50 lances e sem direitos de roque.
+    static bool probe_wdl(const ChessBoard& board, SyzygyWDL& wdl);
+
+    // Melhor lance da raiz pelo DTZ (respeita a regra dos 50 lances)
+    static bool probe_root(const ChessBoard& board, Move& move, SyzygyWDL& wdl);
+};
+
+#endif // SYZYGY_H
@@ -0,0 +1,603 @@
+// Tuner de Texel para a avaliação manual (material, PST, mobilidade, peões, escudo)
+// Uso:
+//   ./texel_tuner pack <posicoes.txt> <posicoes.bin>
+//   ./texel_tuner tune <posicoes.txt|posicoes.bin> [--threads N] [--epochs N] [--lr X] [--k K] [--out DIR]
+//
+// Texto: uma posição por linha, FEN/EPD seguido do resultado ("1-0", "0-1",
+// "1/2-1/2", "[1.0]", "[0.5]", "[0.0]" ou "1.0"/"0.5"/"0.0"), sempre do ponto
+// de vista das brancas. O binário (ver training_data.h) carrega bem mais rápido.
+// Saída: DIR/pesto.h e DIR/eval_params.h, no mesmo formato dos arquivos do repositório.
+
+#include "chess_engine.h"
+#include "pesto.h"
+#include "eval_params.h"
+#include "training_data.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <filesystem>
+
+namespace {
+
+const size_t LOAD_CHUNK = 1 << 16; // Posições por lote de carregamento
+
+// Um termo linear da avaliação: peso de meio-jogo e de final (eg == mg -> sem
+// interpolação; eg < 0 -> apenas meio-jogo)
+struct Term {
+    int mg;
+    int eg;
+};
+
+// Índices dos pesos no vetor de parâmetros
+struct Layout {
+    int material_mg, material_eg;   // [6]
+    int pst_mg, pst_eg;             // [6][64], layout PeSTO
+    int mobility;                   // [6]
+    int passed_mg, passed_eg;       // [8]
+    int isolated_mg, isolated_eg;
+    int doubled_mg, doubled_eg;
+    int backward_mg, backward_eg;
+    int shield_near, shield_far, shield_missing;
+    int count;
+};
+
+struct TraceEntry {
+    uint16_t term;
+    int16_t coef;
+};
+
+struct TunePosition {
+    float result;  // 0, 0.5, 1 (brancas)
+    uint8_t phase;
+    uint8_t count; // Entradas de trace desta posição
+};
+
+struct RawPosition {
+    std::string fen;
+    float result;
+};
+
+struct TuneData {
+    std::vector<TunePosition> positions;
+    std::vector<TraceEntry> entries;
+    // Faixas de posições por thread e o offset da primeira entrada de cada uma
+    std::vector<size_t> range_begin;
+    std::vector<size_t> range_offset;
+};
+
+Layout make_layout() {
+    Layout l;
+    int n = 0;
+    l.material_mg = n; n += 6;
+    l.material_eg = n; n += 6;
+    l.pst_mg = n; n += 6 * 64;
+    l.pst_eg = n; n += 6 * 64;
+    l.mobility = n; n += 6;
+    l.passed_mg = n; n += 8;
+    l.passed_eg = n; n += 8;
+    l.isolated_mg = n++; l.isolated_eg = n++;
+    l.doubled_mg = n++; l.doubled_eg = n++;
+    l.backward_mg = n++; l.backward_eg = n++;
+    l.shield_near = n++; l.shield_far = n++; l.shield_missing = n++;
+    l.count = n;
+    return l;
+}
+
+// Termos na mesma ordem em que trace_to_entries os emite
+std::vector<Term> make_terms(const Layout& l) {
+    std::vector<Term> terms;
+    for (int pt = 0; pt < 6; pt++) terms.push_back({ l.material_mg + pt, l.material_eg + pt });
+    for (int i = 0; i < 6 * 64; i++) terms.push_back({ l.pst_mg + i, l.pst_eg + i });
+    for (int pt = 0; pt < 6; pt++) terms.push_back({ l.mobility + pt, l.mobility + pt });
+    for (int r = 0; r < 8; r++) terms.push_back({ l.passed_mg + r, l.passed_eg + r });
+    terms.push_back({ l.isolated_mg, l.isolated_eg });
+    terms.push_back({ l.doubled_mg, l.doubled_eg });
+    terms.push_back({ l.backward_mg, l.backward_eg });
+    terms.push_back({ l.shield_near, -1 });
+    terms.push_back({ l.shield_far, -1 });
+    terms.push_back({ l.shield_missing, -1 });
+    return terms;
+}
+
+std::vector<double> initial_weights(const Layout& l) {
+    std::vector<double> w(l.count, 0.0);
+    for (int pt = 0; pt < 6; pt++) {
+        w[l.material_mg + pt] = PIECE_VALUE_MG[pt];
+        w[l.material_eg + pt] = PIECE_VALUE_EG[pt];
+        w[l.mobility + pt] = MOBILITY_BONUS[pt];
+        for (int sq = 0; sq < 64; sq++) {
+            w[l.pst_mg + pt * 64 + sq] = PST_MG_TABLES[pt][sq];
+            w[l.pst_eg + pt * 64 + sq] = PST_EG_TABLES[pt][sq];
+        }
+    }
+    for (int r = 0; r < 8; r++) {
+        w[l.passed_mg + r] = PASSED_MG[r];
+        w[l.passed_eg + r] = PASSED_EG[r];
+    }
+    w[l.isolated_mg] = ISOLATED_MG; w[l.isolated_eg] = ISOLATED_EG;
+    w[l.doubled_mg] = DOUBLED_MG; w[l.doubled_eg] = DOUBLED_EG;
+    w[l.backward_mg] = BACKWARD_MG; w[l.backward_eg] = BACKWARD_EG;
+    w[l.shield_near] = SHIELD_NEAR; w[l.shield_far] = SHIELD_FAR; w[l.shield_missing] = SHIELD_MISSING;
+    return w;
+}
+
+void trace_to_entries(const EvalTrace& trace, std::vector<TraceEntry>& out) {
+    int term = 0;
+    auto add = [&](int coef) {
+        if (coef) out.push_back({ (uint16_t)term, (int16_t)coef });
+        term++;
+    };
+    for (int pt = 0; pt < 6; pt++) add(trace.material[pt]);
+    for (int pt = 0; pt < 6; pt++)
+        for (int sq = 0; sq < 64; sq++) add(trace.pst[pt][sq]);
+    for (int pt = 0; pt < 6; pt++) add(trace.mobility[pt]);
+    for (int r = 0; r < 8; r++) add(trace.pawns.passed[r]);
+    add(trace.pawns.isolated);
+    add(trace.pawns.doubled);
+    add(trace.pawns.backward);
+    add(trace.shield.shield_near);
+    add(trace.shield.shield_far);
+    add(trace.shield.shield_missing);
+}
+
+double trace_eval(const TunePosition& pos, const TraceEntry* entries, const std::vector<Term>& terms, const std::vector<double>& w) {
+    double mg = 0, eg = 0;
+    for (int i = 0; i < pos.count; i++) {
+        const Term& t = terms[entries[i].term];
+        mg += entries[i].coef * w[t.mg];
+        if (t.eg >= 0) eg += entries[i].coef * w[t.eg];
+    }
+    return (mg * pos.phase + eg * (MAX_PHASE - pos.phase)) / MAX_PHASE;
+}
+
+double sigmoid(double k, double eval) {
+    return 1.0 / (1.0 + std::pow(10.0, -k * eval / 400.0));
+}
+
+// --- CARREGAMENTO ---
+
+bool parse_result(const std::string& line, float& result) {
+    static const std::pair<const char*, float> TOKENS[] = {
+        { "1/2-1/2", 0.5f }, { "1-0", 1.0f }, { "0-1", 0.0f },
+        { "[0.5]", 0.5f }, { "[1.0]", 1.0f }, { "[0.0]", 0.0f }, { "[1]", 1.0f }, { "[0]", 0.0f }
+    };
+    for (const auto& token : TOKENS) {
+        if (line.find(token.first) != std::string::npos) { result = token.second; return true; }
+    }
+    // Último campo numérico ("... 0.5")
+    size_t end = line.find_last_not_of(" \t;\"");
+    if (end == std::string::npos) return false;
+    size_t start = line.find_last_of(" \t\"", end);
+    std::string last = line.substr(start == std::string::npos ? 0 : start + 1, end - (start == std::string::npos ? 0 : start + 1) + 1);
+    if (last == "1.0" || last == "1") result = 1.0f;
+    else if (last == "0.5") result = 0.5f;
+    else if (last == "0.0" || last == "0") result = 0.0f;
+    else return false;
+    return true;
+}
+
+bool parse_line(const std::string& line, RawPosition& raw) {
+    std::istringstream ss(line);
+    std::string placement, turn, castling, ep;
+    if (!(ss >> placement >> turn >> castling >> ep)) return false;
+    if (std::count(placement.begin(), placement.end(), '/') != 7 || (turn != "w" && turn != "b")) return false;
+    if (placement.find_first_not_of("pnbrqkPNBRQK12345678/") != std::string::npos) return false;
+    if (!parse_result(line, raw.result)) return false;
+    raw.fen = placement + " " + turn + " " + castling + " " + ep + " 0 1";
+    return true;
+}
+
+// Posição quieta: fora de xeque e sem captura que ganhe material de imediato
+// (vítima >= atacante ou casa sem defesa) nem promoção
+bool is_quiet(const ChessBoard& board) {
+    Color us = board.get_side_to_move();
+    if (board.is_check(us)) return false;
+    std::vector<Move> captures = board.generate_legal_captures();
+    if (captures.empty()) return !board.generate_legal_moves().empty();
+
+    Bitboard occupied = 0;
+    for (Square sq = 0; sq < 64; sq++) if (board.get_piece(sq) != NONE) occupied |= 1ULL << sq;
+    for (const Move& m : captures) {
+        if (m.promotion != NONE) return false;
+        PieceType attacker = board.get_piece(m.from);
+        PieceType victim = m.is_en_passant ? PAWN : board.get_piece(m.to);
+        if (PIECE_VALUE_MG[victim] >= PIECE_VALUE_MG[attacker]) return false;
+
+        Bitboard defenders = board.attackers_to(m.to, occupied & ~(1ULL << m.from));
+        bool defended = false;
+        for (Square sq = 0; sq < 64 && !defended; sq++) {
+            if ((defenders >> sq) & 1) defended = (board.get_piece_color(sq) != us);
+        }
+        if (!defended) return false;
+    }
+    return true;
+}
+
+struct LoadStats {
+    size_t read = 0;
+    size_t invalid = 0;
+    size_t not_quiet = 0;
+    size_t trace_mismatch = 0; // Trace diferente de static_evaluation (deve ser 0)
+};
+
+struct LoadContext {
+    int threads;
+    std::vector<std::unique_ptr<ChessEngine>> engines; // Uma por thread (só a avaliação manual)
+    std::vector<Term> terms;
+    std::vector<double> weights;                       // Pesos atuais, para conferir o trace
+};
+
+// Processa um lote em paralelo; cada thread preenche seu pedaço e o resultado
+// é concatenado na ordem original
+void process_chunk(const std::vector<RawPosition>& chunk, LoadContext& ctx, TuneData& data, LoadStats& stats) {
+    struct Partial {
+        std::vector<TunePosition> positions;
+        std::vector<TraceEntry> entries;
+        size_t not_quiet = 0;
+        size_t mismatch = 0;
+    };
+    std::vector<Partial> partials(ctx.threads);
+
+    auto work = [&](int t) {
+        size_t begin = chunk.size() * t / ctx.threads, end = chunk.size() * (t + 1) / ctx.threads;
+        Partial& out = partials[t];
+        EvalTrace trace;
+        for (size_t i = begin; i < end; i++) {
+            ChessBoard board(chunk[i].fen);
+            if (!is_quiet(board)) { out.not_quiet++; continue; }
+
+            ctx.engines[t]->trace_evaluation(board, trace);
+            size_t first = out.entries.size();
+            trace_to_entries(trace, out.entries);
+
+            TunePosition pos;
+            pos.result = chunk[i].result;
+            pos.phase = (uint8_t)trace.phase;
+            pos.count = (uint8_t)(out.entries.size() - first);
+            out.positions.push_back(pos);
+
+            // A engine arredonda a interpolação para inteiro: tolera 1 cp
+            double traced = trace_eval(pos, &out.entries[first], ctx.terms, ctx.weights);
+            if (std::abs(traced - ctx.engines[t]->static_evaluation(board)) > 1.0) out.mismatch++;
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int t = 1; t < ctx.threads; t++) pool.emplace_back(work, t);
+    work(0);
+    for (auto& th : pool) th.join();
+
+    for (Partial& p : partials) {
+        data.positions.insert(data.positions.end(), p.positions.begin(), p.positions.end());
+        data.entries.insert(data.entries.end(), p.entries.begin(), p.entries.end());
+        stats.not_quiet += p.not_quiet;
+        stats.trace_mismatch += p.mismatch;
+    }
+}
+
+bool load_data(const std::string& path, LoadContext& ctx, TuneData& data, LoadStats& stats) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) { std::cerr << "Nao foi possivel abrir " << path << std::endl; return false; }
+
+    char magic[4] = {};
+    file.read(magic, 4);
+    bool binary = file && std::memcmp(magic, TRAINING_DATA_MAGIC, 4) == 0;
+    std::vector<RawPosition> chunk;
+    chunk.reserve(LOAD_CHUNK);
+
+    if (binary) {
+        uint32_t version = 0;
+        file.read(reinterpret_cast<char*>(&version), sizeof(version));
+        if (version != TRAINING_DATA_VERSION) { std::cerr << "Versao de dados nao suportada: " << version << std::endl; return false; }
+        std::vector<PackedPosition> records(LOAD_CHUNK);
+        while (file) {
+            file.read(reinterpret_cast<char*>(records.data()), records.size() * sizeof(PackedPosition));
+            size_t n = file.gcount() / sizeof(PackedPosition);
+            chunk.clear();
+            for (size_t i = 0; i < n; i++) {
+                if (records[i].result > 2) { stats.invalid++; continue; }
+                chunk.push_back({ unpack_fen(records[i]), records[i].result * 0.5f });
+            }
+            stats.read += n;
+            process_chunk(chunk, ctx, data, stats);
+        }
+    } else {
+        file.clear();
+        file.seekg(0);
+        std::string line;
+        while (true) {
+            chunk.clear();
+            while (chunk.size() < LOAD_CHUNK && std::getline(file, line)) {
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                if (line.empty() || line[0] == '#') continue;
+                stats.read++;
+                RawPosition raw;
+                if (parse_line(line, raw)) chunk.push_back(std::move(raw));
+                else stats.invalid++;
+            }
+            if (chunk.empty()) break;
+            process_chunk(chunk, ctx, data, stats);
+        }
+    }
+
+    // Faixas fixas por thread para as épocas (offset da primeira entrada de cada uma)
+    size_t n = data.positions.size();
+    size_t offset = 0, next = 0;
+    for (int t = 0; t < ctx.threads; t++) {
+        size_t begin = n * t / ctx.threads;
+        for (; next < begin; next++) offset += data.positions[next].count;
+        data.range_begin.push_back(begin);
+        data.range_offset.push_back(offset);
+    }
+    data.range_begin.push_back(n);
+    return true;
+}
+
+// --- OTIMIZAÇÃO ---
+
+// Executa fn(t, primeira posição, fim, offset da primeira entrada) em todas as threads
+template <typename Fn>
+void parallel_ranges(const TuneData& data, int threads, Fn fn) {
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; t++) {
+        pool.emplace_back(fn, t, data.range_begin[t], data.range_begin[t + 1], data.range_offset[t]);
+    }
+    fn(0, data.range_begin[0], data.range_begin[1], data.range_offset[0]);
+    for (auto& th : pool) th.join();
+}
+
+double total_error(const TuneData& data, int threads, const std::vector<Term>& terms, const std::vector<double>& w, double k) {
+    std::vector<double> partial(threads, 0.0);
+    parallel_ranges(data, threads, [&](int t, size_t begin, size_t end, size_t offset) {
+        double sum = 0;
+        const TraceEntry* entries = data.entries.data() + offset;
+        for (size_t i = begin; i < end; i++) {
+            const TunePosition& pos = data.positions[i];
+            double diff = pos.result - sigmoid(k, trace_eval(pos, entries, terms, w));
+            sum += diff * diff;
+            entries += pos.count;
+        }
+        partial[t] = sum;
+    });
+    double sum = 0;
+    for (double p : partial) sum += p;
+    return sum / std::max<size_t>(1, data.positions.size());
+}
+
+// K que minimiza o erro com os pesos atuais (busca por seção áurea)
+double fit_k(const TuneData& data, int threads, const std::vector<Term>& terms, const std::vector<double>& w) {
+    const double ratio = (std::sqrt(5.0) - 1) / 2;
+    double a = 0.1, b = 3.0;
+    for (int iter = 0; iter < 40; iter++) {
+        double c = b - ratio * (b - a), d = a + ratio * (b - a);
+        if (total_error(data, threads, terms, w, c) < total_error(data, threads, terms, w, d)) b = d;
+        else a = c;
+    }
+    return (a + b) / 2;
+}
+
+// Gradiente do erro médio (a menos de fatores constantes, absorvidos pelo Adam)
+void compute_gradient(const TuneData& data, int threads, const std::vector<Term>& terms, const std::vector<double>& w,
+                      double k, std::vector<double>& gradient) {
+    std::vector<std::vector<double>> partial(threads, std::vector<double>(w.size(), 0.0));
+    parallel_ranges(data, threads, [&](int t, size_t begin, size_t end, size_t offset) {
+        std::vector<double>& g = partial[t];
+        const TraceEntry* entries = data.entries.data() + offset;
+        for (size_t i = begin; i < end; i++) {
+            const TunePosition& pos = data.positions[i];
+            double s = sigmoid(k, trace_eval(pos, entries, terms, w));
+            double factor = (s - pos.result) * s * (1 - s);
+            double mg_scale = factor * pos.phase / MAX_PHASE;
+            double eg_scale = factor * (MAX_PHASE - pos.phase) / MAX_PHASE;
+            for (int j = 0; j < pos.count; j++) {
+                const Term& term = terms[entries[j].term];
+                g[term.mg] += entries[j].coef * mg_scale;
+                if (term.eg >= 0) g[term.eg] += entries[j].coef * eg_scale;
+            }
+            entries += pos.count;
+        }
+    });
+    std::fill(gradient.begin(), gradient.end(), 0.0);
+    for (const auto& g : partial)
+        for (size_t i = 0; i < g.size(); i++) gradient[i] += g[i];
+}
+
+// --- SAÍDA ---
+
+std::string format_table(const std::vector<double>& w, int base) {
+    std::ostringstream out;
+    for (int rank = 0; rank < 8; rank++) {
+        out << "   ";
+        for (int file = 0; file < 8; file++) {
+            out << std::setw(4) << std::lround(w[base + rank * 8 + file]);
+            if (file < 7) out << ",";
+        }
+        out << (rank < 7 ? ", " : "  ") << "// Rank " << (8 - rank) << "\n";
+    }
+    return out.str();
+}
+
+std::string format_array(const std::vector<double>& w, int base, int count, int width) {
+    std::ostringstream out;
+    out << "{ ";
+    for (int i = 0; i < count; i++) out << (i ? ", " : "") << std::setw(width) << std::lround(w[base + i]);
+    out << " }";
+    return out.str();
+}
+
+bool write_pesto(const std::string& path, const Layout& l, const std::vector<double>& w) {
+    static const char* NAMES[6] = { "PAWN", "KNIGHT", "BISHOP", "ROOK", "QUEEN", "KING" };
+    std::ofstream out(path);
+    if (!out) return false;
+    out << "#ifndef PESTO_H\n#define PESTO_H\n\n"
+        << "// Tabelas PeSTO (meio-jogo e final) usadas pela avaliação \"tapered\".\n"
+        << "// Layout: índice 0 = a8 (Rank 8 primeiro). Para uma peça branca na casa\n"
+        << "// sq (a1 = 0) use sq ^ 56; para uma peça preta use sq diretamente.\n"
+        << "// Gerado pelo texel_tuner.\n\n"
+        << "// Valores materiais [PAWN..KING]\n"
+        << "inline constexpr int PIECE_VALUE_MG[6] = " << format_array(w, l.material_mg, 6, 0) << ";\n"
+        << "inline constexpr int PIECE_VALUE_EG[6] = " << format_array(w, l.material_eg, 6, 0) << ";\n\n"
+        << "// Contribuição de cada peça para a fase do jogo (24 = todas as peças)\n"
+        << "inline constexpr int PHASE_INC[6] = { 0, 1, 1, 2, 4, 0 };\n"
+        << "inline constexpr int MAX_PHASE = 24;\n\n";
+    for (int stage = 0; stage < 2; stage++) {
+        const char* tag = stage ? "EG" : "MG";
+        out << (stage ? "// --- FINAL ---\n" : "// --- MEIO-JOGO ---\n");
+        for (int pt = 0; pt < 6; pt++) {
+            out << "inline constexpr int PST_" << tag << "_" << NAMES[pt] << "[64] = {\n"
+                << format_table(w, (stage ? l.pst_eg : l.pst_mg) + pt * 64) << "};\n\n";
+        }
+    }
+    for (int stage = 0; stage < 2; stage++) {
+        const char* tag = stage ? "EG" : "MG";
+        out << "inline constexpr const int* PST_" << tag << "_TABLES[6] = {\n    ";
+        for (int pt = 0; pt < 6; pt++) out << (pt ? ", " : "") << "PST_" << tag << "_" << NAMES[pt];
+        out << "\n};\n\n";
+    }
+    out << "#endif // PESTO_H\n";
+    return (bool)out;
+}
+
+bool write_eval_params(const std::string& path, const Layout& l, const std::vector<double>& w) {
+    std::ofstream out(path);
+    if (!out) return false;
+    auto v = [&](int index) { return std::lround(w[index]); };
+    out << "#ifndef EVAL_PARAMS_H\n#define EVAL_PARAMS_H\n\n"
+        << "// Pesos da avaliação manual além do material/PST (ver pesto.h).\n"
+        << "// Gerado pelo texel_tuner.\n\n"
+        << "// Bônus por casa atacada, por tipo de peça [PAWN..KING] (sem interpolação de fase)\n"
+        << "inline constexpr int MOBILITY_BONUS[6] = " << format_array(w, l.mobility, 6, 0) << ";\n\n"
+        << "// --- ESTRUTURA DE PEÕES ---\n"
+        << "inline constexpr int PASSED_MG[8] = " << format_array(w, l.passed_mg, 8, 3) << "; // Por rank relativo\n"
+        << "inline constexpr int PASSED_EG[8] = " << format_array(w, l.passed_eg, 8, 3) << ";\n"
+        << "inline constexpr int ISOLATED_MG = " << v(l.isolated_mg) << ", ISOLATED_EG = " << v(l.isolated_eg) << ";\n"
+        << "inline constexpr int DOUBLED_MG  = " << v(l.doubled_mg) << ", DOUBLED_EG  = " << v(l.doubled_eg) << ";\n"
+        << "inline constexpr int BACKWARD_MG = " << v(l.backward_mg) << ", BACKWARD_EG = " << v(l.backward_eg) << ";\n\n"
+        << "// Escudo de peões do rei (apenas meio-jogo)\n"
+        << "inline constexpr int SHIELD_NEAR = " << v(l.shield_near) << ", SHIELD_FAR = " << v(l.shield_far)
+        << ", SHIELD_MISSING = " << v(l.shield_missing) << ";\n\n"
+        << "#endif // EVAL_PARAMS_H\n";
+    return (bool)out;
+}
+
+// --- COMANDOS ---
+
+int pack_command(const std::string& input, const std::string& output) {
+    std::ifstream in(input);
+    std::ofstream out(output, std::ios::binary);
+    if (!in || !out) { std::cerr << "Nao foi possivel abrir " << (!in ? input : output) << std::endl; return 1; }
+    out.write(TRAINING_DATA_MAGIC, 4);
+    out.write(reinterpret_cast<const char*>(&TRAINING_DATA_VERSION), sizeof(TRAINING_DATA_VERSION));
+
+    size_t written = 0, skipped = 0;
+    std::string line;
+    ChessBoard board;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+        RawPosition raw;
+        PackedPosition packed;
+        if (!parse_line(line, raw)) { skipped++; continue; }
+        board.from_fen(raw.fen);
+        if (!pack_position(board, (int)std::lround(raw.result * 2), 0, packed)) { skipped++; continue; }
+        out.write(reinterpret_cast<const char*>(&packed), sizeof(packed));
+        written++;
+    }
+    std::cout << "Posicoes gravadas: " << written << ", ignoradas: " << skipped << std::endl;
+    return 0;
+}
+
+int tune_command(const std::string& input, int threads, int epochs, double lr, double k, const std::string& out_dir) {
+    Layout layout = make_layout();
+    LoadContext ctx;
+    ctx.threads = threads;
+    ctx.terms = make_terms(layout);
+    ctx.weights = initial_weights(layout);
+    for (int t = 0; t < threads; t++) {
+        ctx.engines.emplace_back(new ChessEngine());
+        ctx.engines.back()->set_hash_size(1);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto elapsed = [&]() { return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); };
+
+    TuneData data;
+    LoadStats stats;
+    if (!load_data(input, ctx, data, stats)) return 1;
+    ctx.engines.clear();
+    std::cout << "Lidas: " << stats.read << "  invalidas: " << stats.invalid << "  nao quietas: " << stats.not_quiet
+              << "  usadas: " << data.positions.size() << "  (" << std::fixed << std::setprecision(1) << elapsed() << " s, "
+              << data.entries.size() * sizeof(TraceEntry) / (1024 * 1024) << " MB de traces)" << std::endl;
+    if (stats.trace_mismatch) {
+        std::cerr << "Trace diverge da avaliacao em " << stats.trace_mismatch << " posicoes: trace_evaluation desatualizado" << std::endl;
+        return 1;
+    }
+    if (data.positions.empty()) { std::cerr << "Nenhuma posicao utilizavel" << std::endl; return 1; }
+
+    std::vector<double> w = ctx.weights;
+    if (k <= 0) k = fit_k(data, threads, ctx.terms, w);
+    std::cout << std::setprecision(6) << "K = " << k << "  erro inicial = " << total_error(data, threads, ctx.terms, w, k) << std::endl;
+
+    // Adam com passo em centipawns
+    const double beta1 = 0.9, beta2 = 0.999, epsilon = 1e-8;
+    std::vector<double> gradient(w.size()), m(w.size(), 0.0), v(w.size(), 0.0);
+    for (int epoch = 1; epoch <= epochs; epoch++) {
+        compute_gradient(data, threads, ctx.terms, w, k, gradient);
+        for (size_t i = 0; i < w.size(); i++) {
+            m[i] = beta1 * m[i] + (1 - beta1) * gradient[i];
+            v[i] = beta2 * v[i] + (1 - beta2) * gradient[i] * gradient[i];
+            double m_hat = m[i] / (1 - std::pow(beta1, epoch));
+            double v_hat = v[i] / (1 - std::pow(beta2, epoch));
+            w[i] -= lr * m_hat / (std::sqrt(v_hat) + epsilon);
+        }
+        if (epoch % 25 == 0 || epoch == epochs) {
+            std::cout << "Epoca " << epoch << "  erro = " << total_error(data, threads, ctx.terms, w, k)
+                      << "  (" << std::setprecision(1) << elapsed() << " s)" << std::setprecision(6) << std::endl;
+        }
+    }
+
+    std::filesystem::create_directories(out_dir);
+    std::string pesto_path = out_dir + "/pesto.h", params_path = out_dir + "/eval_params.h";
+    if (!write_pesto(pesto_path, layout, w) || !write_eval_params(params_path, layout, w)) {
+        std::cerr << "Falha ao gravar em " << out_dir << std::endl;
+        return 1;
+    }
+    std::cout << "Pesos gravados em " << pesto_path << " e " << params_path << std::endl;
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    if (args.size() == 3 && args[0] == "pack") return pack_command(args[1], args[2]);
+
+    if (args.size() >= 2 && args[0] == "tune") {
+        int threads = std::max(1u, std::thread::hardware_concurrency());
+        int epochs = 500;
+        double lr = 1.0, k = 0;
+        std::string out_dir = "tuned";
+        for (size_t i = 2; i + 1 < args.size(); i += 2) {
+            if (args[i] == "--threads") threads = std::max(1, std::atoi(args[i + 1].c_str()));
+            else if (args[i] == "--epochs") epochs = std::max(1, std::atoi(args[i + 1].c_str()));
+            else if (args[i] == "--lr") lr = std::atof(args[i + 1].c_str());
+            else if (args[i] == "--k") k = std::atof(args[i + 1].c_str());
+            else if (args[i] == "--out") out_dir = args[i + 1];
+            else { std::cerr << "Opcao desconhecida: " << args[i] << std::endl; return 1; }
+        }
+        return tune_command(args[1], threads, epochs, lr, k, out_dir);
+    }
+
+    std::cerr << "Uso:\n"
+              << "  texel_tuner pack <posicoes.txt> <posicoes.bin>\n"
+              << "  texel_tuner tune <posicoes.txt|.bin> [--threads N] [--epochs N] [--lr X] [--k K] [--out DIR]" << std::endl;
+    return 1;
+}
@@ -0,0 +1,72 @@
+#ifndef TRAINING_DATA_H
+#define TRAINING_DATA_H
+
+#include "chess.h"
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// Posição rotulada compacta (32 bytes) para tuning e treino da avaliação.
+// Arquivo: "CBTD" + versão (u32), seguidos de PackedPosition, little-endian.
+// Roque/en passant não são guardados: só a avaliação estática usa os dados.
+struct PackedPosition {
+    uint64_t occupied;    // Casas ocupadas (a1 = bit 0)
+    uint8_t pieces[16];   // 4 bits por peça (cor * 6 + tipo), na ordem dos bits de occupied
+    uint8_t side_to_move;
+    uint8_t result;       // Ponto de vista das brancas: 0 = derrota, 1 = empate, 2 = vitória
+    int16_t score;        // Avaliação da busca em cp (brancas), 0 se desconhecida
+    uint8_t reserved[4];
+};
+static_assert(sizeof(PackedPosition) == 32, "PackedPosition deve ter 32 bytes");
+
+const char TRAINING_DATA_MAGIC[4] = { 'C', 'B', 'T', 'D' };
+const uint32_t TRAINING_DATA_VERSION = 1;
+
+// false se a posição tiver mais de 32 peças
+inline bool pack_position(const ChessBoard& board, int result, int score, PackedPosition& packed) {
+    std::memset(&packed, 0, sizeof(packed));
+    int count = 0;
+    for (Square sq = 0; sq < 64; sq++) {
+        PieceType pt = board.get_piece(sq);
+        if (pt == NONE) continue;
+        if (count == 32) return false;
+        int code = board.get_piece_color(sq) * 6 + pt;
+        packed.occupied |= 1ULL << sq;
+        packed.pieces[count / 2] |= (uint8_t)(code << ((count & 1) * 4));
+        count++;
+    }
+    packed.side_to_move = (uint8_t)board.get_side_to_move();
+    packed.result = (uint8_t)result;
+    packed.score = (int16_t)score;
+    return true;
+}
+
+inline std::string unpack_fen(const PackedPosition& packed) {
+    static const char SYMBOLS[] = "PNBRQKpnbrqk";
+    char grid[64];
+    std::memset(grid, 0, sizeof(grid));
+    int count = 0;
+    for (Square sq = 0; sq < 64; sq++) {
+        if (!(packed.occupied & (1ULL << sq))) continue;
+        int code = (packed.pieces[count / 2] >> ((count & 1) * 4)) & 0xF;
+        grid[sq] = (code < 12) ? SYMBOLS[code] : 0;
+        count++;
+    }
+
+    std::string fen;
+    for (int rank = 7; rank >= 0; rank--) {
+        int empty = 0;
+        for (int file = 0; file < 8; file++) {
+            char c = grid[rank * 8 + file];
+            if (!c) { empty++; continue; }
+            if (empty) { fen += (char)('0' + empty); empty = 0; }
+            fen += c;
+        }
+        if (empty) fen += (char)('0' + empty);
+        if (rank) fen += '/';
+    }
+    fen += (packed.side_to_move == WHITE) ? " w - - 0 1" : " b - - 0 1";
+    return fen;
+}
+
+#endif // TRAINING_DATA_H